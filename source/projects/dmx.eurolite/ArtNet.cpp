@@ -0,0 +1,213 @@
+#include "ArtNet.hpp"
+#include "UDPSocket.hpp"
+
+#include <cstring>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+// ArtDmx OpCode (sent little endian)
+static const unsigned short artnet_op_dmx = 0x5000;
+
+// ArtDmx header size (data follows)
+static const int artdmx_header_size = 18;
+
+ArtNetReceiver::ArtNetReceiver()
+    : running(false), port_address(0), packet_count(0), dropped_count(0)
+{
+    std::memset(last_sequence, 0, sizeof(last_sequence));
+}
+
+ArtNetReceiver::~ArtNetReceiver()
+{
+    stop();
+}
+
+bool ArtNetReceiver::start(unsigned short aport_address, const std::string &bind_address,
+                           int count)
+{
+    stop();
+    port_address = aport_address & 0x7fff;
+    universe_count = std::max(1, std::min(count, (int)max_universes));
+    std::memset(last_sequence, 0, sizeof(last_sequence));
+
+    // wake up regularly to check if we should stop
+    sock = udp_open_listener(artnet_port, bind_address, 100);
+    if (sock < 0)
+        return false;
+
+    running = true;
+    thread = std::thread(&ArtNetReceiver::receive_loop, this);
+    return true;
+}
+
+void ArtNetReceiver::stop()
+{
+    running = false;
+    if (thread.joinable())
+        thread.join();
+    udp_close(sock);
+    for (int i = 0; i < max_universes; i++)
+        layers[i].reset();
+}
+
+bool ArtNetReceiver::is_running()
+{
+    return running;
+}
+
+DMXLayer *ArtNetReceiver::get_layer(int index)
+{
+    return &layers[std::max(0, std::min(index, (int)max_universes - 1))];
+}
+
+unsigned short ArtNetReceiver::get_port_address()
+{
+    return port_address;
+}
+
+void ArtNetReceiver::set_port_address(unsigned short aport_address)
+{
+    port_address = aport_address & 0x7fff;
+}
+
+unsigned int ArtNetReceiver::get_packet_count()
+{
+    return packet_count;
+}
+
+unsigned int ArtNetReceiver::get_dropped_count()
+{
+    return dropped_count;
+}
+
+void ArtNetReceiver::receive_loop()
+{
+    unsigned char packet[artdmx_header_size + 512];
+    while (running)
+    {
+        const ssize_t length = recv(sock, packet, sizeof(packet), 0);
+        if (length > 0)
+            handle_packet(packet, (int)length);
+    }
+}
+
+void ArtNetReceiver::handle_packet(const unsigned char *packet, int length)
+{
+    if (length < artdmx_header_size || std::memcmp(packet, "Art-Net", 8) != 0)
+        return;
+    if ((packet[8] | (packet[9] << 8)) != artnet_op_dmx)
+        return;
+    // packet[10-11] protocol version, not checked
+    const unsigned char sequence = packet[12];
+    // packet[13] physical port, informative only
+    const unsigned short universe = packet[14] | ((packet[15] & 0x7f) << 8);
+    const int index = (int)universe - (int)port_address;
+    if (index < 0 || index >= universe_count)
+        return;
+    const int size = std::min((packet[16] << 8) | packet[17], length - artdmx_header_size);
+    if (size <= 0)
+        return;
+
+    // drop packets arriving out of order (within half of sequence range)
+    unsigned char &last = last_sequence[index];
+    if (sequence != 0 && last != 0 &&
+        (signed char)(sequence - last) <= 0 &&
+        (signed char)(sequence - last) > -64)
+    {
+        dropped_count++;
+        return;
+    }
+    last = sequence;
+    packet_count++;
+
+    DMXLayer &layer = layers[index];
+    std::memcpy(layer.write_buffer(), packet + artdmx_header_size, std::min(size, 512));
+    layer.publish((unsigned short)std::min(size, 512));
+}
+
+// ---- SENDER ----
+
+ArtNetSender::ArtNetSender()
+    : port_address(0), packet_count(0), dropped_count(0)
+{
+    std::memset(packet, 0, sizeof(packet));
+    std::memcpy(packet, "Art-Net", 8);
+    packet[8] = artnet_op_dmx & 0xff;   // OpCode (LSB first)
+    packet[9] = artnet_op_dmx >> 8;
+    packet[10] = 0;                     // protocol version 14
+    packet[11] = 14;
+    packet[16] = 512 >> 8;              // length (MSB first)
+    packet[17] = 512 & 0xff;
+}
+
+ArtNetSender::~ArtNetSender()
+{
+    stop();
+}
+
+bool ArtNetSender::start(const std::string &adestination, unsigned short aport_address,
+                         const std::string &bind_address)
+{
+    stop();
+    struct in_addr addr;
+    if (inet_pton(AF_INET, adestination.c_str(), &addr) != 1)
+        return false;
+    destination = ntohl(addr.s_addr);
+    port_address = aport_address & 0x7fff;
+    sock = udp_open_sender(bind_address);
+    return sock >= 0;
+}
+
+void ArtNetSender::stop()
+{
+    udp_close(sock);
+}
+
+bool ArtNetSender::is_running()
+{
+    return sock >= 0;
+}
+
+void ArtNetSender::set_port_address(unsigned short aport_address)
+{
+    port_address = aport_address & 0x7fff;
+}
+
+unsigned short ArtNetSender::get_port_address()
+{
+    return port_address;
+}
+
+unsigned int ArtNetSender::get_packet_count()
+{
+    return packet_count;
+}
+
+unsigned int ArtNetSender::get_dropped_count()
+{
+    return dropped_count;
+}
+
+void ArtNetSender::frame_sent(const unsigned char *slots, int size)
+{
+    if (sock < 0)
+        return;
+    const unsigned short universe = port_address;
+    if (++sequence == 0) // 0 means "no sequencing"
+        sequence = 1;
+    packet[12] = sequence;
+    packet[14] = universe & 0xff;     // SubUni
+    packet[15] = universe >> 8;       // Net
+    std::memcpy(packet + artdmx_header_size, slots, std::min(size, 512));
+
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(artnet_port);
+    addr.sin_addr.s_addr = htonl(destination);
+    if (sendto(sock, packet, sizeof(packet), 0, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+        dropped_count++; // EAGAIN, ENOBUFS... never queue or retry
+    else
+        packet_count++;
+}
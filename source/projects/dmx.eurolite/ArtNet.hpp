@@ -0,0 +1,138 @@
+/**
+ * Art-Net (ArtDmx) receiver and sender
+ * receiver feeds a DMX layer from a network thread,
+ * sender mirrors transmitted frames.
+ * Andrzej Kopeć, 2018
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <string>
+#include <thread>
+#include "DMXLayer.hpp"
+#include "libUSB_EuroliteDMX512USB.hpp"
+
+// Art-Net UDP port
+static const unsigned short artnet_port = 6454;
+
+class ArtNetReceiver
+{
+  public:
+    ArtNetReceiver();
+
+    ~ArtNetReceiver();
+
+    // most consecutive universes received by one receiver
+    static const int max_universes = 16;
+
+    /** Starts listening
+     *
+     *  @param  port_address    15-bit Art-Net port address (net:7, subnet:4, universe:4)
+     *  @param  bind_address    Local IPv4 address to bind to ("" = any)
+     *  @param  count           Count of consecutive port addresses received
+     *                          (each one feeds its own layer)
+     *  @return true if the socket was opened
+     */
+    bool start(unsigned short port_address, const std::string &bind_address = "",
+               int count = 1);
+
+    void stop();
+
+    bool is_running();
+
+    /**
+     * Layer fed with received frames (add it to the device).
+     *
+     *  @param  index   Universe relative to port address
+     */
+    DMXLayer *get_layer(int index = 0);
+
+    unsigned short get_port_address();
+
+    /**
+     * Changes universe without restarting the socket.
+     */
+    void set_port_address(unsigned short port_address);
+
+    unsigned int get_packet_count();
+
+    unsigned int get_dropped_count();
+
+  private:
+    DMXLayer layers[max_universes];
+    int universe_count = 1;
+
+    int sock = -1;
+    std::thread thread;
+    std::atomic<bool> running;
+
+    std::atomic<unsigned short> port_address;
+
+    // last sequence numbers (0 = sequencing disabled by sender)
+    unsigned char last_sequence[max_universes];
+
+    std::atomic<unsigned int> packet_count;
+    std::atomic<unsigned int> dropped_count;
+
+    /**
+     * Network thread.
+     */
+    void receive_loop();
+
+    /**
+     * Parses a datagram, publishes DMX if it is ArtDmx for our universe.
+     */
+    void handle_packet(const unsigned char *packet, int length);
+};
+
+class ArtNetSender : public DMXFrameListener
+{
+  public:
+    ArtNetSender();
+
+    ~ArtNetSender();
+
+    /** Opens the socket
+     *
+     *  @param  destination     Destination IPv4 address (node or broadcast)
+     *  @param  port_address    15-bit Art-Net port address
+     *  @param  bind_address    Local IPv4 address of the interface to send from ("" = any)
+     *  @return true if the socket was opened
+     */
+    bool start(const std::string &destination, unsigned short port_address,
+               const std::string &bind_address = "");
+
+    void stop();
+
+    bool is_running();
+
+    void set_port_address(unsigned short port_address);
+
+    unsigned short get_port_address();
+
+    /**
+     * Sends ArtDmx with the frame (never blocks, drops when the
+     * network can't take it).
+     */
+    void frame_sent(const unsigned char *slots, int size) override;
+
+    unsigned int get_packet_count();
+
+    unsigned int get_dropped_count();
+
+  private:
+    int sock = -1;
+    unsigned int destination = 0;
+
+    // preassembled packet, only sequence, universe and data change
+    unsigned char packet[18 + 512];
+
+    unsigned char sequence = 0;
+
+    std::atomic<unsigned short> port_address;
+
+    std::atomic<unsigned int> packet_count;
+    std::atomic<unsigned int> dropped_count;
+};
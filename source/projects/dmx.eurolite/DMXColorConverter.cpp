@@ -0,0 +1,161 @@
+#include "DMXColorConverter.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+DMXColorConverter::DMXColorConverter()
+{
+    white[0] = white[1] = white[2] = 1.f;
+    amber[0] = 1.f;
+    amber[1] = 0.5f;
+    amber[2] = 0.f;
+}
+
+int DMXColorConverter::get_footprint(output_t output)
+{
+    switch (output)
+    {
+    case OUTPUT_RGBW:
+    case OUTPUT_RGBA:
+        return 4;
+    case OUTPUT_RGBAW:
+        return 5;
+    default:
+        return 3;
+    }
+}
+
+bool DMXColorConverter::add(int channel, int count, input_t input, output_t output)
+{
+    if (channel < 0 || count <= 0 || channel + count * get_footprint(output) > 512)
+        return false;
+    std::lock_guard<std::mutex> lock(converter_mutex);
+    batches.push_back({channel, count, input, output});
+    fixture_count += count;
+    return true;
+}
+
+void DMXColorConverter::clear()
+{
+    std::lock_guard<std::mutex> lock(converter_mutex);
+    batches.clear();
+    fixture_count = 0;
+}
+
+void DMXColorConverter::set_white_point(float r, float g, float b)
+{
+    std::lock_guard<std::mutex> lock(converter_mutex);
+    white[0] = std::max(0.f, std::min(1.f, r));
+    white[1] = std::max(0.f, std::min(1.f, g));
+    white[2] = std::max(0.f, std::min(1.f, b));
+}
+
+void DMXColorConverter::set_amber_point(float r, float g, float b)
+{
+    std::lock_guard<std::mutex> lock(converter_mutex);
+    amber[0] = std::max(0.f, std::min(1.f, r));
+    amber[1] = std::max(0.f, std::min(1.f, g));
+    amber[2] = std::max(0.f, std::min(1.f, b));
+}
+
+int DMXColorConverter::get_fixture_count()
+{
+    std::lock_guard<std::mutex> lock(converter_mutex);
+    return fixture_count;
+}
+
+void DMXColorConverter::extract(float *r, float *g, float *b, float *out, int count,
+                                const float *point)
+{
+    // components the point doesn't have don't limit it (limit 1.)
+    const float inv_r = point[0] > 0 ? 1.f / point[0] : 0.f;
+    const float inv_g = point[1] > 0 ? 1.f / point[1] : 0.f;
+    const float inv_b = point[2] > 0 ? 1.f / point[2] : 0.f;
+    const float off_r = point[0] > 0 ? 0.f : 1.f;
+    const float off_g = point[1] > 0 ? 0.f : 1.f;
+    const float off_b = point[2] > 0 ? 0.f : 1.f;
+    // a black point makes no light, the emitter stays off
+    const float lit = point[0] > 0 || point[1] > 0 || point[2] > 0 ? 1.f : 0.f;
+    for (int i = 0; i < count; i++)
+    {
+        const float amount = lit * std::min(
+            1.f, std::min(r[i] * inv_r + off_r,
+                          std::min(g[i] * inv_g + off_g, b[i] * inv_b + off_b)));
+        out[i] = amount;
+        r[i] = std::max(0.f, r[i] - amount * point[0]);
+        g[i] = std::max(0.f, g[i] - amount * point[1]);
+        b[i] = std::max(0.f, b[i] - amount * point[2]);
+    }
+}
+
+void DMXColorConverter::frame_will_send(unsigned char *slots, int size)
+{
+    std::lock_guard<std::mutex> lock(converter_mutex);
+    for (const batch &batch : batches)
+    {
+        const int footprint = get_footprint(batch.output);
+        const int count = batch.count;
+        if (batch.channel + count * footprint > size)
+            continue;
+        unsigned char *fixture = slots + batch.channel;
+
+        for (int i = 0; i < count; i++)
+        {
+            const unsigned char *in = fixture + i * footprint;
+            r[i] = in[0] * (1.f / 255.f);
+            g[i] = in[1] * (1.f / 255.f);
+            b[i] = in[2] * (1.f / 255.f);
+        }
+
+        if (batch.input == INPUT_HSV)
+            for (int i = 0; i < count; i++)
+            {
+                // r, g, b hold h, s, v; hue wraps at 1.
+                const float h = r[i] * 6.f;
+                const float s = g[i];
+                const float v = b[i];
+                const float f = h - std::floor(h);
+                const float p = v * (1.f - s);
+                const float q = v * (1.f - s * f);
+                const float t = v * (1.f - s * (1.f - f));
+                switch ((int)h % 6)
+                {
+                case 0: r[i] = v; g[i] = t; b[i] = p; break;
+                case 1: r[i] = q; g[i] = v; b[i] = p; break;
+                case 2: r[i] = p; g[i] = v; b[i] = t; break;
+                case 3: r[i] = p; g[i] = q; b[i] = v; break;
+                case 4: r[i] = t; g[i] = p; b[i] = v; break;
+                default: r[i] = v; g[i] = p; b[i] = q; break;
+                }
+            }
+
+        // white first (it covers the most), amber from what is left
+        if (batch.output == OUTPUT_RGBW || batch.output == OUTPUT_RGBAW)
+            extract(r, g, b, w, count, white);
+        if (batch.output == OUTPUT_RGBA || batch.output == OUTPUT_RGBAW)
+            extract(r, g, b, a, count, amber);
+
+        for (int i = 0; i < count; i++)
+        {
+            unsigned char *out = fixture + i * footprint;
+            out[0] = (unsigned char)(r[i] * 255.f + 0.5f);
+            out[1] = (unsigned char)(g[i] * 255.f + 0.5f);
+            out[2] = (unsigned char)(b[i] * 255.f + 0.5f);
+            switch (batch.output)
+            {
+            case OUTPUT_RGBW:
+                out[3] = (unsigned char)(w[i] * 255.f + 0.5f);
+                break;
+            case OUTPUT_RGBA:
+                out[3] = (unsigned char)(a[i] * 255.f + 0.5f);
+                break;
+            case OUTPUT_RGBAW:
+                out[3] = (unsigned char)(a[i] * 255.f + 0.5f);
+                out[4] = (unsigned char)(w[i] * 255.f + 0.5f);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+}
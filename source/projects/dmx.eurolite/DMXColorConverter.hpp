@@ -0,0 +1,100 @@
+/**
+ * Colour conversion - HSV/RGB input expanded to RGB, RGBW, RGBA or
+ * RGBAW fixtures when the frame is built.
+ * Andrzej Kopeć, 2018
+ */
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+#include "libUSB_EuroliteDMX512USB.hpp"
+
+/**
+ * Fixtures to convert are added in batches of consecutive fixtures of
+ * the same kind. Each frame, the first three channels of every fixture
+ * are read as R G B (or H S V), converted and written over the whole
+ * fixture footprint in the output order (R G B [A] [W]). White and
+ * amber are extracted as the largest part of the colour they can
+ * make, given their colour points (their light as R G B fractions).
+ *
+ * Works on logical channels, before masters and the patch.
+ */
+class DMXColorConverter : public DMXFrameListener
+{
+  public:
+    enum input_t
+    {
+        INPUT_RGB,
+        INPUT_HSV
+    };
+
+    enum output_t
+    {
+        OUTPUT_RGB,
+        OUTPUT_RGBW,
+        OUTPUT_RGBA,
+        OUTPUT_RGBAW
+    };
+
+    DMXColorConverter();
+
+    /** Adds consecutive fixtures
+     *
+     *  @param  channel     First channel of the first fixture
+     *  @param  count       Count of fixtures (footprint is the output size)
+     *  @return false if the fixtures go past channel 511
+     */
+    bool add(int channel, int count, input_t input, output_t output);
+
+    void clear();
+
+    /**
+     * White LED colour (0.-1. each, default 1. 1. 1.), 0. 0. 0. leaves
+     * the white LED off.
+     */
+    void set_white_point(float r, float g, float b);
+
+    /**
+     * Amber LED colour (default 1. 0.5 0.), 0. 0. 0. leaves the amber
+     * LED off.
+     */
+    void set_amber_point(float r, float g, float b);
+
+    int get_fixture_count();
+
+    static int get_footprint(output_t output);
+
+    void frame_will_send(unsigned char *slots, int size) override;
+
+    void frame_sent(const unsigned char *, int) override {}
+
+  private:
+    struct batch
+    {
+        int channel;
+        int count;
+        input_t input;
+        output_t output;
+    };
+
+    std::mutex converter_mutex;
+    std::vector<batch> batches;
+    int fixture_count = 0;
+
+    float white[3];
+    float amber[3];
+
+    // --- one batch at a time, structure of arrays (frame builder only)
+    float r[512];
+    float g[512];
+    float b[512];
+    float a[512];
+    float w[512];
+
+    /**
+     * Takes the largest amount of a colour point out of r, g, b.
+     */
+    static void extract(float *r, float *g, float *b, float *out, int count,
+                        const float *point);
+};
@@ -0,0 +1,161 @@
+#include "DMXCueStack.hpp"
+
+static float fade_rate(double time_ms)
+{
+    // zero time jumps right away
+    return time_ms > 0 ? (float)(1. / (time_ms * 1000.)) : 1.f;
+}
+
+DMXCueStack::DMXCueStack(LibUSB_EuroliteDMX512USB *adevice)
+    : device(adevice), requested(-1), current(-1), fading(false)
+{
+    std::memset(from, 0, sizeof(from));
+    std::memset(delta, 0, sizeof(delta));
+    std::memset(rate, 0, sizeof(rate));
+}
+
+int DMXCueStack::record(int index)
+{
+    DMXCue cue;
+    device->get_channels(cue.values);
+    cue.in_ms = 0;
+    cue.out_ms = 0;
+    cue.delay_ms = 0;
+    cue.follow_ms = -1;
+    std::lock_guard<std::mutex> lock(cues_mutex);
+    if (index < 0 || index >= (int)cues.size())
+    {
+        cues.push_back(cue);
+        return (int)cues.size() - 1;
+    }
+    // keep the times of a re-recorded cue
+    std::memcpy(cues[index].values, cue.values, 512);
+    return index;
+}
+
+bool DMXCueStack::set_times(int index, double in_ms, double out_ms,
+                            double delay_ms, double follow_ms)
+{
+    std::lock_guard<std::mutex> lock(cues_mutex);
+    if (index < 0 || index >= (int)cues.size())
+        return false;
+    DMXCue &cue = cues[index];
+    cue.in_ms = std::max(0., in_ms);
+    cue.out_ms = std::max(0., out_ms);
+    cue.delay_ms = std::max(0., delay_ms);
+    cue.follow_ms = follow_ms;
+    return true;
+}
+
+bool DMXCueStack::remove(int index)
+{
+    std::lock_guard<std::mutex> lock(cues_mutex);
+    if (index < 0 || index >= (int)cues.size())
+        return false;
+    cues.erase(cues.begin() + index);
+    return true;
+}
+
+void DMXCueStack::clear()
+{
+    std::lock_guard<std::mutex> lock(cues_mutex);
+    cues.clear();
+    requested = -1;
+    current = -1;
+}
+
+int DMXCueStack::get_cue_count()
+{
+    std::lock_guard<std::mutex> lock(cues_mutex);
+    return (int)cues.size();
+}
+
+void DMXCueStack::go()
+{
+    go_to(current + 1);
+}
+
+void DMXCueStack::back()
+{
+    go_to(std::max(0, current - 1));
+}
+
+void DMXCueStack::go_to(int index)
+{
+    if (index >= 0 && index < get_cue_count())
+        requested = index;
+}
+
+int DMXCueStack::get_current()
+{
+    return current;
+}
+
+bool DMXCueStack::is_fading()
+{
+    return fading;
+}
+
+void DMXCueStack::frame_will_build()
+{
+    const uint64_t now = DMXLayer::now_us();
+    int index = requested.exchange(-1);
+
+    // auto follow
+    if (index < 0 && !fading && follow_ms >= 0 &&
+        now >= fade_end_us + (uint64_t)(follow_ms * 1000.))
+    {
+        follow_ms = -1;
+        if (current + 1 < get_cue_count())
+            index = current + 1;
+    }
+
+    if (index < 0 && !fading)
+        return;
+    device->write_channels(0, 512, [this, index, now](unsigned char *out, int) {
+        if (index >= 0)
+            start_crossfade(index, out, now);
+        if (!fading)
+            return;
+        if (now < fade_start_us) // delay
+            return;
+        if (now >= fade_end_us)
+        {
+            advance(out, 1e30f); // exactly at the cue
+            fading = false;
+        }
+        else
+            advance(out, (float)(now - fade_start_us));
+    });
+}
+
+void DMXCueStack::start_crossfade(int index, const unsigned char *out, uint64_t now)
+{
+    std::lock_guard<std::mutex> lock(cues_mutex);
+    if (index >= (int)cues.size()) // removed in the meantime
+        return;
+    const DMXCue &cue = cues[index];
+    const float rate_in = fade_rate(cue.in_ms);
+    const float rate_out = fade_rate(cue.out_ms);
+    for (int i = 0; i < 512; i++)
+    {
+        from[i] = out[i];
+        delta[i] = (float)cue.values[i] - out[i];
+        rate[i] = delta[i] >= 0 ? rate_in : rate_out;
+    }
+    fade_start_us = now + (uint64_t)(cue.delay_ms * 1000.);
+    fade_end_us = fade_start_us + (uint64_t)(std::max(cue.in_ms, cue.out_ms) * 1000.);
+    follow_ms = cue.follow_ms;
+    current = index;
+    fading = true;
+}
+
+void DMXCueStack::advance(unsigned char *out, float elapsed_us)
+{
+    // branch free so the loop vectorises
+    for (int i = 0; i < 512; i++)
+    {
+        const float p = std::min(1.f, elapsed_us * rate[i]);
+        out[i] = (unsigned char)(from[i] + delta[i] * p + 0.5f);
+    }
+}
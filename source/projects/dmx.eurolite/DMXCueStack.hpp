@@ -0,0 +1,119 @@
+/**
+ * Cue stack - recorded frames played back with timed crossfades
+ * evaluated once per frame right before the frame is built.
+ * Andrzej Kopeć, 2018
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include "libUSB_EuroliteDMX512USB.hpp"
+
+struct DMXCue
+{
+    unsigned char values[512];
+
+    // fade time of channels going up / down (ms)
+    double in_ms;
+    double out_ms;
+
+    // wait before the crossfade starts (ms)
+    double delay_ms;
+
+    // next cue goes automatically this long after the crossfade
+    // completes (ms), negative = wait for go
+    double follow_ms;
+};
+
+/**
+ * Cues are numbered from 0. The crossfade writes the whole universe
+ * into the device's back buffer, so the reached cue stays there and
+ * can be changed by other writes afterwards. Control methods may be
+ * called from any thread, they take effect with the next frame.
+ */
+class DMXCueStack : public DMXFrameListener
+{
+  public:
+    DMXCueStack(LibUSB_EuroliteDMX512USB *device);
+
+    /** Records the device's back buffer as a cue
+     *
+     *  @param  index   Cue to replace, or -1 (or past the end) to append
+     *  @return         Index of the recorded cue
+     */
+    int record(int index = -1);
+
+    /**
+     * Sets times of a cue (ms), returns false if there is no such cue.
+     */
+    bool set_times(int index, double in_ms, double out_ms, double delay_ms,
+                   double follow_ms);
+
+    bool remove(int index);
+
+    void clear();
+
+    int get_cue_count();
+
+    /**
+     * Crossfades to the next cue.
+     */
+    void go();
+
+    /**
+     * Crossfades to the previous cue.
+     */
+    void back();
+
+    void go_to(int index);
+
+    /**
+     * Cue being faded to or reached last, -1 before the first go.
+     */
+    int get_current();
+
+    /**
+     * True while a crossfade (or its delay) is running.
+     */
+    bool is_fading();
+
+    void frame_will_build() override;
+
+    void frame_sent(const unsigned char *, int) override {}
+
+  private:
+    LibUSB_EuroliteDMX512USB *device;
+
+    // recorded cues (guarded by cues_mutex)
+    std::mutex cues_mutex;
+    std::vector<DMXCue> cues;
+
+    // requested cue, -1 = none (taken by the frame builder)
+    std::atomic<int> requested;
+
+    std::atomic<int> current;
+    std::atomic<bool> fading;
+
+    // --- crossfade state, structure of arrays (frame builder only)
+
+    float from[512];
+    float delta[512];
+    // 1 / fade time in us of each channel (in or out time)
+    float rate[512];
+    uint64_t fade_start_us = 0;
+    uint64_t fade_end_us = 0;
+    double follow_ms = -1;
+
+    /**
+     * Starts the crossfade to a cue (out: current frame values).
+     */
+    void start_crossfade(int index, const unsigned char *out, uint64_t now);
+
+    /**
+     * Writes crossfade values for the time elapsed since the start.
+     */
+    void advance(unsigned char *out, float elapsed_us);
+};
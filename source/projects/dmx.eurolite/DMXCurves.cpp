@@ -0,0 +1,122 @@
+#include "DMXCurves.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+DMXCurves::DMXCurves()
+{
+    for (int c = 0; c < max_curves; c++)
+    {
+        for (int i = 0; i < 257; i++)
+            tables16[c][i] = (uint16_t)std::min(65535, i * 257);
+        for (int i = 0; i < 256; i++)
+            tables8[c][i] = (unsigned char)i;
+    }
+    std::memset(curve_of, 0, sizeof(curve_of));
+    std::memset(wide_of, 0, sizeof(wide_of));
+}
+
+template <typename F> bool DMXCurves::build(int curve, F f)
+{
+    if (curve < 1 || curve >= max_curves)
+        return false;
+    uint16_t table16[257];
+    unsigned char table8[256];
+    for (int i = 0; i < 256; i++)
+    {
+        const float y = std::max(0.f, std::min(1.f, f(i / 255.f)));
+        table16[i] = (uint16_t)(y * 65535.f + 0.5f);
+        table8[i] = (unsigned char)(y * 255.f + 0.5f);
+    }
+    table16[256] = table16[255];
+    std::lock_guard<std::mutex> lock(curves_mutex);
+    std::memcpy(tables16[curve], table16, sizeof(table16));
+    std::memcpy(tables8[curve], table8, sizeof(table8));
+    return true;
+}
+
+bool DMXCurves::set_gamma(int curve, float gamma)
+{
+    if (!(gamma > 0))
+        return false;
+    return build(curve, [gamma](float x) { return std::pow(x, gamma); });
+}
+
+bool DMXCurves::set_scurve(int curve, float k)
+{
+    if (!(k > 0))
+        return false;
+    return build(curve, [k](float x) {
+        const float a = std::pow(x, k);
+        const float b = std::pow(1.f - x, k);
+        return a + b > 0 ? a / (a + b) : x;
+    });
+}
+
+bool DMXCurves::set_custom(int curve, const float *points, int count)
+{
+    if (count < 2)
+        return false;
+    return build(curve, [points, count](float x) {
+        const float pos = x * (count - 1);
+        const int i = std::min(count - 2, (int)pos);
+        return points[i] + (points[i + 1] - points[i]) * (pos - i);
+    });
+}
+
+bool DMXCurves::assign(int curve, int from, int c, bool wide)
+{
+    if (curve < 0 || curve >= max_curves || from < 0 || from > 511 || c <= 0)
+        return false;
+    const int slots = std::min(wide ? c * 2 : c, 512 - from);
+    std::lock_guard<std::mutex> lock(curves_mutex);
+    // a pair whose fine channel is reassigned becomes 8-bit (a pair
+    // starting at the last slot is rewritten by the loop)
+    if (from > 0)
+        wide_of[from - 1] = false;
+    for (int i = from; i < from + slots; i++)
+    {
+        curve_of[i] = (unsigned char)curve;
+        // a pair split by the end of the universe is treated as 8-bit
+        wide_of[i] = wide && curve && (i - from) % 2 == 0 && i < 511;
+    }
+    assigned_count = 0;
+    for (int i = 0; i < 512; i++)
+        assigned_count += curve_of[i] != 0;
+    return true;
+}
+
+int DMXCurves::get_assigned_count()
+{
+    std::lock_guard<std::mutex> lock(curves_mutex);
+    return assigned_count;
+}
+
+void DMXCurves::frame_will_send(unsigned char *slots, int size)
+{
+    std::lock_guard<std::mutex> lock(curves_mutex);
+    if (!assigned_count)
+        return;
+    const int count = std::min(size, 512);
+    for (int i = 0; i < count; i++)
+    {
+        const unsigned char *table8 = tables8[curve_of[i]];
+        if (!wide_of[i] || i + 1 >= count)
+        {
+            slots[i] = table8[slots[i]];
+            continue;
+        }
+        // 16-bit value / 257 picks the table point (the points are at
+        // i / 255 of full scale), the remainder interpolates
+        const uint32_t wide = (slots[i] << 8) | slots[i + 1];
+        const uint16_t *table16 = tables16[curve_of[i]];
+        const uint32_t point = wide / 257;
+        const int frac = (int)(wide - point * 257);
+        const uint32_t value =
+            table16[point] + (((int)table16[point + 1] - (int)table16[point]) * frac) / 257;
+        slots[i] = (unsigned char)(value >> 8);
+        slots[i + 1] = (unsigned char)(value & 0xff);
+        i++;
+    }
+}
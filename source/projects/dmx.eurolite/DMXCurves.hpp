@@ -0,0 +1,79 @@
+/**
+ * Response curves - per-channel lookup tables applied to
+ * physical slots as the last stage of every frame.
+ * Andrzej Kopeć, 2018
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include "libUSB_EuroliteDMX512USB.hpp"
+
+/**
+ * Each physical slot uses one of max_curves tables, curve 0 is linear
+ * and can't be changed. A slot may also be the coarse byte of a 16-bit
+ * pair: the pair is then looked up as one 16-bit value (interpolated
+ * between table points) and written back as coarse/fine bytes.
+ */
+class DMXCurves : public DMXFrameListener
+{
+  public:
+    static const int max_curves = 16;
+
+    DMXCurves();
+
+    /** Power curve, out = in ^ gamma
+     *
+     *  @param  curve   1 - max_curves-1
+     */
+    bool set_gamma(int curve, float gamma);
+
+    /** Symmetric S-curve, out = in^k / (in^k + (1-in)^k)
+     *
+     *  @param  k   Steepness (1 = linear)
+     */
+    bool set_scurve(int curve, float k);
+
+    /** Custom curve from evenly spaced points (0.-1.), resampled
+     *  linearly to the table.
+     *
+     *  @param  count   At least 2 points
+     */
+    bool set_custom(int curve, const float *points, int count);
+
+    /** Assigns slots to a curve (0 = linear)
+     *
+     *  @param  wide    Slots are coarse/fine pairs starting at from,
+     *                  c is the count of pairs
+     */
+    bool assign(int curve, int from, int c, bool wide = false);
+
+    /**
+     * Count of slots using a curve other than linear.
+     */
+    int get_assigned_count();
+
+    void frame_will_send(unsigned char *slots, int size) override;
+
+    void frame_sent(const unsigned char *, int) override {}
+
+  private:
+    std::mutex curves_mutex;
+
+    // same curve points (i / 255) at both resolutions, 16-bit tables
+    // have a spare end point for interpolation
+    uint16_t tables16[max_curves][257];
+    unsigned char tables8[max_curves][256];
+
+    unsigned char curve_of[512];
+    // slot is the coarse byte of a pair (next slot is fine)
+    bool wide_of[512];
+
+    int assigned_count = 0;
+
+    /**
+     * Fills curve from f(x), x = 0.-1. (caller holds no lock).
+     */
+    template <typename F> bool build(int curve, F f);
+};
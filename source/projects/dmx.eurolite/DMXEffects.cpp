@@ -0,0 +1,137 @@
+#include "DMXEffects.hpp"
+
+#include <cmath>
+
+static const float two_pi = 6.28318530718f;
+
+DMXEffects::DMXEffects()
+{
+}
+
+DMXEffect DMXEffects::make(DMXEffect::waveform_t waveform, int start, int count,
+                           float rate_hz)
+{
+    DMXEffect e;
+    e.waveform = waveform;
+    e.combine = DMXEffect::COMBINE_HTP;
+    e.start = start;
+    e.count = count;
+    e.rate_hz = rate_hz;
+    e.spread = waveform == DMXEffect::CHASE ? 1.f : 0.f;
+    e.depth = 255.f;
+    if (waveform == DMXEffect::CHASE)
+        e.width = count > 0 ? 1.f / count : 1.f;
+    else if (waveform == DMXEffect::STROBE)
+        e.width = 0.1f;
+    else
+        e.width = 0.5f;
+    return e;
+}
+
+int DMXEffects::add(const DMXEffect &effect)
+{
+    running_t r;
+    r.effect = effect;
+    r.effect.start = std::max(0, std::min(511, effect.start));
+    r.effect.count = std::max(0, std::min(512 - r.effect.start, effect.count));
+    r.effect.depth = std::max(0.f, std::min(255.f, effect.depth));
+    r.effect.width = std::max(0.f, std::min(1.f, effect.width));
+    r.start_us = 0;
+    std::lock_guard<std::mutex> lock(effects_mutex);
+    r.id = next_id++;
+    effects.push_back(r);
+    return r.id;
+}
+
+bool DMXEffects::remove(int id)
+{
+    std::lock_guard<std::mutex> lock(effects_mutex);
+    for (size_t i = 0; i < effects.size(); i++)
+        if (effects[i].id == id)
+        {
+            effects.erase(effects.begin() + i);
+            return true;
+        }
+    return false;
+}
+
+void DMXEffects::clear()
+{
+    std::lock_guard<std::mutex> lock(effects_mutex);
+    effects.clear();
+}
+
+int DMXEffects::get_count()
+{
+    std::lock_guard<std::mutex> lock(effects_mutex);
+    return (int)effects.size();
+}
+
+void DMXEffects::render(const DMXEffect &e, double cycles, float *values)
+{
+    const float base = (float)(cycles - std::floor(cycles));
+    const float spread_step = e.count > 0 ? e.spread / e.count : 0.f;
+
+    // phases first, then one branch-free loop per waveform
+    for (int i = 0; i < e.count; i++)
+    {
+        const float p = base - spread_step * i;
+        values[i] = p - std::floor(p);
+    }
+    switch (e.waveform)
+    {
+    case DMXEffect::SINE:
+        for (int i = 0; i < e.count; i++)
+            values[i] = 0.5f - 0.5f * std::cos(two_pi * values[i]);
+        break;
+    case DMXEffect::RAMP:
+        break;
+    case DMXEffect::TRIANGLE:
+        for (int i = 0; i < e.count; i++)
+            values[i] = 1.f - std::fabs(2.f * values[i] - 1.f);
+        break;
+    case DMXEffect::SQUARE:
+    case DMXEffect::CHASE:
+    case DMXEffect::STROBE:
+        for (int i = 0; i < e.count; i++)
+            values[i] = values[i] < e.width ? 1.f : 0.f;
+        break;
+    }
+}
+
+void DMXEffects::frame_will_send(unsigned char *slots, int size)
+{
+    std::lock_guard<std::mutex> lock(effects_mutex);
+    if (effects.empty())
+        return;
+    const uint64_t now = DMXLayer::now_us();
+    float values[512];
+    for (size_t k = 0; k < effects.size(); k++)
+    {
+        running_t &r = effects[k];
+        if (!r.start_us)
+            r.start_us = now;
+        const DMXEffect &e = r.effect;
+        const int count = std::min(e.count, size - e.start);
+        if (count <= 0)
+            continue;
+        render(e, (now - r.start_us) * 1e-6 * e.rate_hz, values);
+
+        unsigned char *out = slots + e.start;
+        switch (e.combine)
+        {
+        case DMXEffect::COMBINE_HTP:
+            for (int i = 0; i < count; i++)
+                out[i] = std::max(out[i], (unsigned char)(values[i] * e.depth + 0.5f));
+            break;
+        case DMXEffect::COMBINE_ADD:
+            for (int i = 0; i < count; i++)
+                out[i] = (unsigned char)std::min(255.f, out[i] + values[i] * e.depth + 0.5f);
+            break;
+        case DMXEffect::COMBINE_REPLACE:
+            for (int i = 0; i < count; i++)
+                out[i] = (unsigned char)(values[i] * e.depth + 0.5f);
+            break;
+        }
+    }
+}
@@ -0,0 +1,103 @@
+/**
+ * Effect generators (LFOs, chases, strobes) over channel ranges
+ * evaluated once per frame and combined with the built frame.
+ * Andrzej Kopeć, 2018
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "libUSB_EuroliteDMX512USB.hpp"
+
+struct DMXEffect
+{
+    enum waveform_t
+    {
+        SINE,     // 0 at phase 0, depth at half cycle
+        RAMP,     // rises over the cycle
+        TRIANGLE, // up and down
+        SQUARE,   // on for width of the cycle
+        CHASE,    // square, one channel at a time by default
+        STROBE    // short flashes of all channels
+    };
+
+    enum combine_t
+    {
+        COMBINE_HTP,    // highest of frame and effect
+        COMBINE_ADD,    // added to the frame (saturated)
+        COMBINE_REPLACE // effect replaces the frame
+    };
+
+    waveform_t waveform;
+    combine_t combine;
+
+    // channel range
+    int start;
+    int count;
+
+    // cycles per second
+    float rate_hz;
+
+    // phase difference across the range (in cycles, 1 = spread over the whole cycle)
+    float spread;
+
+    // peak value (0.-255.)
+    float depth;
+
+    // on part of the cycle for square, chase and strobe (0.-1.)
+    float width;
+};
+
+/**
+ * Effects run on the frame builder's clock: each one is evaluated for
+ * the time of the frame being built. Effects may be added and removed
+ * from any thread.
+ */
+class DMXEffects : public DMXFrameListener
+{
+  public:
+    DMXEffects();
+
+    /** Starts an effect (phase 0 at the next frame)
+     *
+     *  @return id of the effect
+     */
+    int add(const DMXEffect &effect);
+
+    /**
+     * Fills an effect with defaults for the waveform: full depth,
+     * chase one channel after another, short strobe flashes.
+     */
+    static DMXEffect make(DMXEffect::waveform_t waveform, int start, int count,
+                          float rate_hz);
+
+    bool remove(int id);
+
+    void clear();
+
+    int get_count();
+
+    void frame_will_send(unsigned char *slots, int size) override;
+
+    void frame_sent(const unsigned char *, int) override {}
+
+  private:
+    struct running_t
+    {
+        int id;
+        DMXEffect effect;
+        // 0 until the first frame
+        uint64_t start_us;
+    };
+
+    std::mutex effects_mutex;
+    std::vector<running_t> effects;
+    int next_id = 1;
+
+    /**
+     * Waveform values (0.-1.) of the effect's channels at the time.
+     */
+    static void render(const DMXEffect &e, double cycles, float *values);
+};
@@ -0,0 +1,122 @@
+#include "DMXFader.hpp"
+
+DMXFader::DMXFader(LibUSB_EuroliteDMX512USB *adevice)
+    : device(adevice), active_count(0)
+{
+    std::memset(pending, 0, sizeof(pending));
+    std::memset(start, 0, sizeof(start));
+    std::memset(delta, 0, sizeof(delta));
+    std::memset(progress, 0, sizeof(progress));
+    std::memset(step, 0, sizeof(step));
+    std::memset(active, 0, sizeof(active));
+}
+
+void DMXFader::fade(int from, int c, const unsigned char *targets, double time_ms)
+{
+    if (from < 0 || from > 511 || c <= 0) // safety check
+        return;
+    if (c + from > 512) // safety check
+        c = 512 - from;
+    const uint64_t now = DMXLayer::now_us();
+    // a zero time fade completes on the first frame
+    const float fade_step = time_ms > 0 ? (float)(1. / (time_ms * 1000.)) : 1.f;
+    std::lock_guard<std::mutex> lock(pending_mutex);
+    for (int i = 0; i < c; i++)
+    {
+        const int ch = from + i;
+        if (!pending[ch])
+            pending_count++;
+        pending[ch] = true;
+        pending_target[ch] = targets[i];
+        pending_step[ch] = fade_step;
+        pending_us[ch] = now;
+    }
+}
+
+void DMXFader::fade_range(int from, int c, unsigned char target, double time_ms)
+{
+    unsigned char targets[512];
+    std::memset(targets, target, sizeof(targets));
+    fade(from, std::min(c, 512), targets, time_ms);
+}
+
+void DMXFader::stop()
+{
+    std::lock_guard<std::mutex> lock(pending_mutex);
+    std::memset(pending, 0, sizeof(pending));
+    pending_count = 0;
+    pending_stop = true;
+}
+
+int DMXFader::get_active_count()
+{
+    return active_count;
+}
+
+void DMXFader::frame_will_build()
+{
+    const uint64_t now = DMXLayer::now_us();
+    const float dt = last_frame_us ? (float)(now - last_frame_us) : 0.f;
+    last_frame_us = now;
+
+    std::lock_guard<std::mutex> lock(pending_mutex);
+    if (pending_stop)
+    {
+        std::memset(active, 0, sizeof(active));
+        std::memset(step, 0, sizeof(step));
+        active_count = 0;
+        pending_stop = false;
+    }
+    if (!pending_count && !active_count)
+        return;
+    device->write_channels(0, 512, [this, now, dt](unsigned char *out, int) {
+        advance(out, dt);
+        take_pending(out, now);
+    });
+}
+
+void DMXFader::take_pending(const unsigned char *out, uint64_t now)
+{
+    if (!pending_count)
+        return;
+    for (int i = 0; i < 512; i++)
+    {
+        if (!pending[i])
+            continue;
+        if (active[i] == 0.f)
+            active_count++;
+        start[i] = out[i];
+        delta[i] = (float)pending_target[i] - out[i];
+        step[i] = pending_step[i];
+        // time already elapsed since the request counts
+        progress[i] = std::min(1.f, (float)(now - pending_us[i]) * step[i]);
+        active[i] = 1.f;
+        pending[i] = false;
+    }
+    pending_count = 0;
+    // new fades show their first value in this frame
+    advance(const_cast<unsigned char *>(out), 0.f);
+}
+
+void DMXFader::advance(unsigned char *out, float dt)
+{
+    // branch free over the whole universe so the loop vectorises;
+    // inactive channels have step 0 and keep their value
+    int finished = 0;
+    for (int i = 0; i < 512; i++)
+    {
+        const float p = std::min(1.f, progress[i] + dt * step[i]);
+        const float value = start[i] + delta[i] * p + 0.5f;
+        progress[i] = p;
+        out[i] = active[i] != 0.f ? (unsigned char)value : out[i];
+    }
+    // retire completed fades (they have written their target)
+    for (int i = 0; i < 512; i++)
+        if (active[i] != 0.f && progress[i] >= 1.f)
+        {
+            active[i] = 0.f;
+            step[i] = 0.f;
+            finished++;
+        }
+    active_count -= finished;
+}
@@ -0,0 +1,87 @@
+/**
+ * Timed per-channel fades evaluated once per frame
+ * right before the frame is built.
+ * Andrzej Kopeć, 2018
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include "libUSB_EuroliteDMX512USB.hpp"
+
+/**
+ * Fades write into the device's back buffer, so a finished fade leaves
+ * the target value there. Channels being faded ignore other writes
+ * until the fade ends (or is stopped).
+ *
+ * Fades may be started from any thread; they begin at the value the
+ * channel has when the next frame is built, timed from the call.
+ */
+class DMXFader : public DMXFrameListener
+{
+  public:
+    DMXFader(LibUSB_EuroliteDMX512USB *device);
+
+    /** Fades consecutive channels to their own targets
+     *
+     *  @param  from        The first channel
+     *  @param  c           Count of channels
+     *  @param  targets     Target values
+     *  @param  time_ms     Fade time (0 = next frame)
+     */
+    void fade(int from, int c, const unsigned char *targets, double time_ms);
+
+    /**
+     * Fades consecutive channels to the same target.
+     */
+    void fade_range(int from, int c, unsigned char target, double time_ms);
+
+    /**
+     * Stops all fades, channels keep their current values.
+     */
+    void stop();
+
+    int get_active_count();
+
+    void frame_will_build() override;
+
+    void frame_sent(const unsigned char *, int) override {}
+
+  private:
+    LibUSB_EuroliteDMX512USB *device;
+
+    // --- fades requested since the last frame (guarded by pending_mutex)
+
+    std::mutex pending_mutex;
+    bool pending[512];
+    bool pending_stop = false;
+    int pending_count = 0;
+    unsigned char pending_target[512];
+    float pending_step[512];
+    uint64_t pending_us[512];
+
+    // --- running fades, structure of arrays (frame builder only)
+
+    float start[512];
+    float delta[512];
+    // progress 0.-1. and its increment per microsecond
+    float progress[512];
+    float step[512];
+    // 1.f for channels being faded, 0.f otherwise
+    float active[512];
+    std::atomic<int> active_count;
+
+    uint64_t last_frame_us = 0;
+
+    /**
+     * Moves pending fades to the running ones (out: current frame values).
+     */
+    void take_pending(const unsigned char *out, uint64_t now);
+
+    /**
+     * Advances all fades by dt and writes them to out.
+     */
+    void advance(unsigned char *out, float dt);
+};
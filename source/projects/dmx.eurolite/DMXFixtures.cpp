@@ -0,0 +1,156 @@
+#include "DMXFixtures.hpp"
+
+#include <algorithm>
+#include <map>
+
+DMXFixtures::DMXFixtures(LibUSB_EuroliteDMX512USB *device) : device(device)
+{
+}
+
+bool DMXFixtures::add_profile(const DMXFixtureProfile &profile)
+{
+    if (profile.attributes.empty())
+        return false;
+    for (const DMXFixtureAttribute &a : profile.attributes)
+    {
+        if (a.offsets.empty())
+            return false;
+        for (int offset : a.offsets)
+            if (offset < 0)
+                return false;
+    }
+    for (DMXFixtureProfile &p : profiles)
+        if (p.name == profile.name)
+        {
+            p = profile;
+            return true;
+        }
+    profiles.push_back(profile);
+    return true;
+}
+
+bool DMXFixtures::add_fixture(int number, const std::string &profile, int address)
+{
+    if (number < 0 || number >= max_fixtures || address < 0 || address > 511)
+        return false;
+    fixture_defs.push_back({number, profile, address});
+    return true;
+}
+
+bool DMXFixtures::compile(std::string &error)
+{
+    std::map<std::string, int> name_numbers;
+    std::vector<std::string> names;
+    std::vector<std::vector<int>> table;
+    std::vector<binding> compiled;
+
+    for (const fixture_def &f : fixture_defs)
+    {
+        const DMXFixtureProfile *profile = NULL;
+        for (const DMXFixtureProfile &p : profiles)
+            if (p.name == f.profile)
+                profile = &p;
+        if (!profile)
+        {
+            error = "fixture " + std::to_string(f.number) + ": no profile " + f.profile;
+            return false;
+        }
+        if ((int)table.size() <= f.number)
+            table.resize(f.number + 1);
+        for (const DMXFixtureAttribute &a : profile->attributes)
+        {
+            binding b;
+            b.wide = a.wide;
+            b.first = 511;
+            int last = 0;
+            for (int offset : a.offsets)
+            {
+                const int channel = f.address + offset;
+                b.channels.push_back(channel);
+                b.first = std::min(b.first, channel);
+                last = std::max(last, channel + (a.wide ? 1 : 0));
+            }
+            if (last > 511)
+            {
+                error = "fixture " + std::to_string(f.number) + " " + a.name +
+                        " is past channel 511";
+                return false;
+            }
+            b.count = last - b.first + 1;
+
+            std::map<std::string, int>::iterator n = name_numbers.find(a.name);
+            if (n == name_numbers.end())
+            {
+                n = name_numbers.insert(std::make_pair(a.name, (int)names.size())).first;
+                names.push_back(a.name);
+            }
+            std::vector<int> &attributes = table[f.number];
+            if ((int)attributes.size() <= n->second)
+                attributes.resize(n->second + 1, -1);
+            attributes[n->second] = (int)compiled.size();
+            compiled.push_back(b);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(tables_mutex);
+    attribute_names.swap(names);
+    fixture_attributes.swap(table);
+    bindings.swap(compiled);
+    fixture_count = (int)fixture_defs.size();
+    return true;
+}
+
+void DMXFixtures::clear()
+{
+    clear_definitions();
+    std::lock_guard<std::mutex> lock(tables_mutex);
+    attribute_names.clear();
+    fixture_attributes.clear();
+    bindings.clear();
+    fixture_count = 0;
+}
+
+void DMXFixtures::clear_definitions()
+{
+    profiles.clear();
+    fixture_defs.clear();
+}
+
+std::vector<std::string> DMXFixtures::get_attribute_names()
+{
+    std::lock_guard<std::mutex> lock(tables_mutex);
+    return attribute_names;
+}
+
+int DMXFixtures::get_fixture_count()
+{
+    std::lock_guard<std::mutex> lock(tables_mutex);
+    return fixture_count;
+}
+
+bool DMXFixtures::set(int fixture, int attribute, const float *values, int c)
+{
+    std::lock_guard<std::mutex> lock(tables_mutex);
+    if (fixture < 0 || fixture >= (int)fixture_attributes.size() || attribute < 0 ||
+        attribute >= (int)fixture_attributes[fixture].size() ||
+        fixture_attributes[fixture][attribute] < 0)
+        return false;
+    const binding &b = bindings[fixture_attributes[fixture][attribute]];
+    const int count = std::min(c, (int)b.channels.size());
+    device->write_channels(b.first, b.count, [&b, values, count](unsigned char *dest, int) {
+        for (int i = 0; i < count; i++)
+        {
+            const float v = values[i] > 0 ? std::min(1.f, values[i]) : 0.f; // NaN too
+            const int offset = b.channels[i] - b.first;
+            if (b.wide)
+            {
+                const int wide = (int)(v * 65535.f + 0.5f);
+                dest[offset] = (unsigned char)(wide >> 8);
+                dest[offset + 1] = (unsigned char)(wide & 0xff);
+            }
+            else
+                dest[offset] = (unsigned char)(v * 255.f + 0.5f);
+        }
+    });
+    return true;
+}
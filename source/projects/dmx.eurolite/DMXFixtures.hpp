@@ -0,0 +1,122 @@
+/**
+ * Fixture profiles - named attributes of fixtures compiled into
+ * channel tables, so attribute writes need no lookups.
+ * Andrzej Kopeć, 2018
+ */
+
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include "libUSB_EuroliteDMX512USB.hpp"
+
+struct DMXFixtureAttribute
+{
+    std::string name;
+    // channel offsets from the fixture address, one per component
+    std::vector<int> offsets;
+    // components are coarse/fine pairs (fine at offset + 1)
+    bool wide;
+};
+
+struct DMXFixtureProfile
+{
+    std::string name;
+    std::vector<DMXFixtureAttribute> attributes;
+};
+
+/**
+ * Profiles and fixtures are loaded together, then compiled: attribute
+ * names get numbers shared by all profiles and every fixture gets a
+ * table of absolute channels per attribute number. Writes go to the
+ * device's back buffer (logical channels).
+ */
+class DMXFixtures
+{
+  public:
+    static const int max_fixtures = 1024;
+
+    DMXFixtures(LibUSB_EuroliteDMX512USB *device);
+
+    /** Adds a profile (replaces one with the same name), takes effect
+     *  on compile().
+     *
+     *  @return false if it has no attributes, an attribute has no
+     *          offsets or an offset is negative
+     */
+    bool add_profile(const DMXFixtureProfile &profile);
+
+    /** Adds a fixture, takes effect on compile().
+     *
+     *  @param  number      Fixture number (0 - max_fixtures-1)
+     *  @param  address     First channel (0-511)
+     */
+    bool add_fixture(int number, const std::string &profile, int address);
+
+    /** Builds channel tables from profiles and fixtures added since the
+     *  last clear() or clear_definitions(). The tables in use are
+     *  replaced only on success, nothing changes if a fixture doesn't fit.
+     *
+     *  @param  error   Description of the problem on failure
+     */
+    bool compile(std::string &error);
+
+    /**
+     * Removes all profiles and fixtures, compiled tables too.
+     */
+    void clear();
+
+    /**
+     * Removes profiles and fixtures not compiled yet, the compiled
+     * tables stay in use (for loading a new rig).
+     */
+    void clear_definitions();
+
+    /** Attribute names in the compiled tables, the position is the
+     *  attribute number used by set().
+     */
+    std::vector<std::string> get_attribute_names();
+
+    int get_fixture_count();
+
+    /** Writes an attribute of a fixture
+     *
+     *  @param  fixture     Fixture number
+     *  @param  attribute   Attribute number
+     *  @param  values      Values 0.-1., one per component (extra are ignored)
+     *  @return false if the fixture has no such attribute
+     */
+    bool set(int fixture, int attribute, const float *values, int c);
+
+  private:
+    LibUSB_EuroliteDMX512USB *device;
+
+    // --- definitions (not compiled yet)
+    std::vector<DMXFixtureProfile> profiles;
+    struct fixture_def
+    {
+        int number;
+        std::string profile;
+        int address;
+    };
+    std::vector<fixture_def> fixture_defs;
+
+    // --- compiled tables (guarded by tables_mutex)
+
+    struct binding
+    {
+        // absolute coarse channel of each component
+        std::vector<int> channels;
+        bool wide;
+        // channel span written
+        int first;
+        int count;
+    };
+    std::mutex tables_mutex;
+    std::vector<std::string> attribute_names;
+    // per fixture number: binding index per attribute number, -1 = none
+    std::vector<std::vector<int>> fixture_attributes;
+    std::vector<binding> bindings;
+    int fixture_count = 0;
+};
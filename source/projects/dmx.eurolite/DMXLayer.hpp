@@ -0,0 +1,125 @@
+/**
+ * DMX layer - a universe written from another thread
+ * (network receivers etc.) and merged into the transmitted frame.
+ * header-only
+ * Andrzej Kopeć, 2018
+ */
+
+#pragma once
+
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+/**
+ * Lock-free triple buffer: one writer thread fills write_buffer() and
+ * calls publish(), one reader (frame builder) always sees the latest
+ * complete frame. Neither side ever waits for the other.
+ */
+class DMXLayer
+{
+  public:
+    enum merge_t
+    {
+        MERGE_HTP, // highest takes precedence
+        MERGE_LTP  // layer replaces channels it covers
+    };
+
+    DMXLayer()
+        : merge(MERGE_HTP), middle(1), last_publish_us(0)
+    {
+        std::memset(buffers, 0, sizeof(buffers));
+        std::memset(sizes, 0, sizeof(sizes));
+    }
+
+    /**
+     * Buffer to be filled by the writer (512 slots).
+     */
+    unsigned char *write_buffer()
+    {
+        return buffers[write_index];
+    }
+
+    /** Makes the write buffer visible to the reader
+     *
+     *  @param  size    Count of valid slots
+     */
+    void publish(unsigned short size)
+    {
+        sizes[write_index] = std::min<unsigned short>(size, 512);
+        const int previous = middle.exchange(write_index | dirty_flag, std::memory_order_acq_rel);
+        write_index = previous & index_mask;
+        last_publish_us.store(now_us(), std::memory_order_relaxed);
+    }
+
+    /** Latest published frame (reader side)
+     *
+     *  @param  size    Count of valid slots (0 if nothing was published)
+     *  @return         Pointer to 512 slots
+     */
+    const unsigned char *read(unsigned short &size)
+    {
+        if (middle.load(std::memory_order_relaxed) & dirty_flag)
+        {
+            const int previous = middle.exchange(read_index, std::memory_order_acq_rel);
+            read_index = previous & index_mask;
+        }
+        size = sizes[read_index];
+        return buffers[read_index];
+    }
+
+    /**
+     * Merges the latest frame into out (512 slots), nothing until the
+     * first publish or after reset(). Layers hold their last frame,
+     * writers that time out sources (sACN) reset the layer themselves.
+     */
+    void merge_into(unsigned char *out)
+    {
+        if (last_publish_us.load(std::memory_order_relaxed) == 0)
+            return;
+        unsigned short size;
+        const unsigned char *in = read(size);
+        if (merge == MERGE_LTP)
+            std::memcpy(out, in, size);
+        else
+            for (int i = 0; i < size; i++)
+                out[i] = std::max(out[i], in[i]);
+    }
+
+    /**
+     * Forgets published data (layer stops affecting output until
+     * the next publish).
+     */
+    void reset()
+    {
+        last_publish_us.store(0, std::memory_order_relaxed);
+    }
+
+    static uint64_t now_us()
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    // merge mode (set before adding the layer)
+    merge_t merge;
+
+  private:
+    static const int dirty_flag = 4;
+    static const int index_mask = 3;
+
+    unsigned char buffers[3][512];
+    unsigned short sizes[3];
+
+    // owned by the writer / the reader
+    int write_index = 0;
+    int read_index = 2;
+
+    // buffer exchanged between writer and reader (+ dirty flag)
+    std::atomic<int> middle;
+
+    std::atomic<uint64_t> last_publish_us;
+};
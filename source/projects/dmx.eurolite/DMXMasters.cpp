@@ -0,0 +1,119 @@
+#include "DMXMasters.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+DMXMasters::DMXMasters()
+{
+    for (int i = 0; i <= max_submasters; i++)
+    {
+        levels[i].value = 1.f;
+        levels[i].target = 1.f;
+        levels[i].step = 0.f;
+    }
+    std::memset(intensity, 1, sizeof(intensity));
+    std::memset(group, -1, sizeof(group));
+}
+
+void DMXMasters::set_level(level_t &l, float level, double time_ms)
+{
+    l.target = std::max(0.f, std::min(1.f, level));
+    if (time_ms > 0)
+        l.step = (float)(std::fabs(l.target - l.value) / (time_ms * 1000.));
+    else
+    {
+        l.value = l.target;
+        l.step = 0.f;
+    }
+}
+
+void DMXMasters::advance_level(level_t &l, float dt)
+{
+    if (l.value < l.target)
+        l.value = std::min(l.target, l.value + l.step * dt);
+    else if (l.value > l.target)
+        l.value = std::max(l.target, l.value - l.step * dt);
+}
+
+void DMXMasters::set_grand_master(float level, double time_ms)
+{
+    std::lock_guard<std::mutex> lock(masters_mutex);
+    set_level(levels[0], level, time_ms);
+}
+
+bool DMXMasters::set_submaster(int index, float level, double time_ms)
+{
+    if (index < 0 || index >= max_submasters)
+        return false;
+    std::lock_guard<std::mutex> lock(masters_mutex);
+    set_level(levels[1 + index], level, time_ms);
+    return true;
+}
+
+bool DMXMasters::assign(int submaster, int from, int c)
+{
+    if (submaster < -1 || submaster >= max_submasters || from < 0 || from > 511 || c <= 0)
+        return false;
+    c = std::min(c, 512 - from);
+    std::lock_guard<std::mutex> lock(masters_mutex);
+    std::memset(group + from, submaster, c);
+    return true;
+}
+
+void DMXMasters::set_intensity(int from, int c, bool is_intensity)
+{
+    if (from < 0 || from > 511 || c <= 0)
+        return;
+    c = std::min(c, 512 - from);
+    std::lock_guard<std::mutex> lock(masters_mutex);
+    std::memset(intensity + from, is_intensity ? 1 : 0, c);
+}
+
+float DMXMasters::get_grand_master()
+{
+    std::lock_guard<std::mutex> lock(masters_mutex);
+    return levels[0].value;
+}
+
+float DMXMasters::get_submaster(int index)
+{
+    if (index < 0 || index >= max_submasters)
+        return 0.f;
+    std::lock_guard<std::mutex> lock(masters_mutex);
+    return levels[1 + index].value;
+}
+
+void DMXMasters::frame_will_send(unsigned char *slots, int size)
+{
+    const uint64_t now = DMXLayer::now_us();
+    const float dt = last_frame_us ? (float)(now - last_frame_us) : 0.f;
+    last_frame_us = now;
+
+    std::lock_guard<std::mutex> lock(masters_mutex);
+    bool all_full = true;
+    for (int i = 0; i <= max_submasters; i++)
+    {
+        advance_level(levels[i], dt);
+        all_full = all_full && levels[i].value >= 1.f;
+    }
+    if (all_full)
+        return;
+
+    // per group scale in 1.16 fixed point: index 0 = no submaster,
+    // index 1 + n = submaster n (grand master included)
+    uint32_t group_scale[1 + max_submasters];
+    const float grand = levels[0].value;
+    group_scale[0] = (uint32_t)(grand * 65536.f + 0.5f);
+    for (int i = 0; i < max_submasters; i++)
+        group_scale[1 + i] = (uint32_t)(grand * levels[1 + i].value * 65536.f + 0.5f);
+
+    uint32_t scale[512];
+    for (int i = 0; i < 512; i++)
+        scale[i] = intensity[i] ? group_scale[group[i] + 1] : 65536u;
+
+    // multiply-shift, vectorised by the compiler
+    const int count = std::min(size, 512);
+    for (int i = 0; i < count; i++)
+        slots[i] = (unsigned char)((slots[i] * scale[i] + 32768u) >> 16);
+}
@@ -0,0 +1,76 @@
+/**
+ * Output scaling stage - grand master, submasters and
+ * intensity mask applied to every frame.
+ * Andrzej Kopeć, 2018
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include "libUSB_EuroliteDMX512USB.hpp"
+
+/**
+ * Channels marked as intensity are scaled by the grand master and by
+ * the submaster of their group (if any). Other channels (pan, tilt,
+ * colour...) pass unchanged. All channels are intensity by default.
+ * Levels (0.-1.) may be faded, fades run on the frame clock.
+ */
+class DMXMasters : public DMXFrameListener
+{
+  public:
+    static const int max_submasters = 16;
+
+    DMXMasters();
+
+    /** Sets the grand master
+     *
+     *  @param  level       0.-1.
+     *  @param  time_ms     Fade time (0 = next frame)
+     */
+    void set_grand_master(float level, double time_ms = 0);
+
+    bool set_submaster(int index, float level, double time_ms = 0);
+
+    /**
+     * Assigns channels to a submaster (-1 = none).
+     */
+    bool assign(int submaster, int from, int c);
+
+    /**
+     * Marks channels as intensity (scaled) or not.
+     */
+    void set_intensity(int from, int c, bool is_intensity);
+
+    float get_grand_master();
+
+    float get_submaster(int index);
+
+    void frame_will_send(unsigned char *slots, int size) override;
+
+    void frame_sent(const unsigned char *, int) override {}
+
+  private:
+    struct level_t
+    {
+        float value;
+        float target;
+        // change per microsecond
+        float step;
+    };
+
+    std::mutex masters_mutex;
+
+    // 0 = grand master, then submasters
+    level_t levels[1 + max_submasters];
+
+    bool intensity[512];
+    // submaster of each channel, -1 = none
+    int8_t group[512];
+
+    uint64_t last_frame_us = 0;
+
+    static void set_level(level_t &l, float level, double time_ms);
+
+    static void advance_level(level_t &l, float dt);
+};
@@ -0,0 +1,133 @@
+#include "DMXPatch.hpp"
+
+#include <fstream>
+#include <sstream>
+
+static const uint16_t unpatched = 512;
+
+DMXPatch::DMXPatch()
+{
+    for (int i = 0; i < 512; i++)
+        source[i] = unpatched;
+}
+
+bool DMXPatch::patch(int logical, int physical)
+{
+    if (logical < 0 || logical > 511 || physical < 0 || physical > 511)
+        return false;
+    std::lock_guard<std::mutex> lock(patch_mutex);
+    source[physical] = (uint16_t)logical;
+    enabled = true;
+    return true;
+}
+
+bool DMXPatch::unpatch(int physical)
+{
+    if (physical < 0 || physical > 511)
+        return false;
+    std::lock_guard<std::mutex> lock(patch_mutex);
+    source[physical] = unpatched;
+    return true;
+}
+
+void DMXPatch::clear()
+{
+    std::lock_guard<std::mutex> lock(patch_mutex);
+    for (int i = 0; i < 512; i++)
+        source[i] = unpatched;
+    enabled = false;
+}
+
+void DMXPatch::set_table(const int *sources)
+{
+    uint16_t table[512];
+    for (int i = 0; i < 512; i++)
+        table[i] = (sources[i] >= 0 && sources[i] < 512) ? (uint16_t)sources[i] : unpatched;
+    std::lock_guard<std::mutex> lock(patch_mutex);
+    std::memcpy(source, table, sizeof(source));
+    enabled = true;
+}
+
+bool DMXPatch::load_file(const std::string &path, std::string &error)
+{
+    std::ifstream file(path.c_str());
+    if (!file)
+    {
+        error = "can't open " + path;
+        return false;
+    }
+    int sources[512];
+    for (int i = 0; i < 512; i++)
+        sources[i] = -1;
+
+    std::string line;
+    int line_number = 0;
+    int mappings = 0;
+    while (std::getline(file, line))
+    {
+        line_number++;
+        const size_t comment = line.find('#');
+        if (comment != std::string::npos)
+            line.erase(comment);
+        std::istringstream fields(line);
+        int logical, physical;
+        if (!(fields >> logical) && fields.eof())
+            continue; // empty line
+        bool valid = !fields.fail() && logical >= 0 && logical <= 511;
+        int outputs = 0;
+        while (valid && fields >> physical)
+        {
+            valid = physical >= 0 && physical <= 511;
+            if (valid)
+                sources[physical] = logical;
+            outputs++;
+        }
+        if (!valid || !fields.eof() || outputs == 0)
+        {
+            std::ostringstream oss;
+            oss << path << ":" << line_number << ": expected <logical> <physical>... (0-511)";
+            error = oss.str();
+            return false;
+        }
+        mappings++;
+    }
+    if (!mappings)
+    {
+        // would unpatch (black out) every slot
+        error = path + ": no channels patched";
+        return false;
+    }
+    set_table(sources);
+    return true;
+}
+
+bool DMXPatch::is_enabled()
+{
+    std::lock_guard<std::mutex> lock(patch_mutex);
+    return enabled;
+}
+
+int DMXPatch::get_patched_count()
+{
+    std::lock_guard<std::mutex> lock(patch_mutex);
+    int count = 0;
+    for (int i = 0; i < 512; i++)
+        count += source[i] != unpatched;
+    return count;
+}
+
+void DMXPatch::frame_will_send(unsigned char *slots, int size)
+{
+    std::lock_guard<std::mutex> lock(patch_mutex);
+    if (!enabled)
+        return;
+    // logical frame plus the constant 0 slot unpatched slots point to
+    unsigned char logical[513];
+    std::memcpy(logical, slots, std::min(size, 512));
+    if (size < 512)
+        std::memset(logical + size, 0, 512 - size);
+    logical[512] = 0;
+    // branch-free gather
+    for (int i = 0; i < size && i < 512; i++)
+        slots[i] = logical[source[i]];
+}
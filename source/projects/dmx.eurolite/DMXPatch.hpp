@@ -0,0 +1,78 @@
+/**
+ * Patch table - maps logical channels to physical DMX addresses,
+ * applied once per frame as a gather.
+ * Andrzej Kopeć, 2018
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include "libUSB_EuroliteDMX512USB.hpp"
+
+/**
+ * Everything written to the device (messages, layers, effects...) is
+ * in logical channels. When the patch is enabled, each physical slot
+ * takes the value of the logical channel patched to it; a logical
+ * channel may feed any number of physical slots, unpatched slots are 0.
+ * Without any patch the frame goes out unchanged.
+ */
+class DMXPatch : public DMXFrameListener
+{
+  public:
+    DMXPatch();
+
+    /** Patches a logical channel to a physical slot (replacing what
+     *  fed that slot before). Enables the patch.
+     *
+     *  @param  logical     Logical channel (0-511)
+     *  @param  physical    Physical slot (0-511)
+     */
+    bool patch(int logical, int physical);
+
+    /**
+     * Disconnects a physical slot.
+     */
+    bool unpatch(int physical);
+
+    /**
+     * Removes all patching (the frame goes out unchanged).
+     */
+    void clear();
+
+    /** Replaces the patch from a text file, one logical channel per line:
+     *    <logical> <physical> [<physical>...]
+     *  '#' starts a comment. The old patch stays if the file is broken
+     *  or patches nothing.
+     *
+     *  @param  error   Description of the problem on failure
+     */
+    bool load_file(const std::string &path, std::string &error);
+
+    /** Replaces the whole table at once
+     *
+     *  @param  sources     Logical channel of each of 512 physical slots, -1 = none
+     */
+    void set_table(const int *sources);
+
+    bool is_enabled();
+
+    /**
+     * Count of physical slots patched.
+     */
+    int get_patched_count();
+
+    void frame_will_send(unsigned char *slots, int size) override;
+
+    void frame_sent(const unsigned char *, int) override {}
+
+  private:
+    std::mutex patch_mutex;
+
+    // logical source of each physical slot, 512 = unpatched
+    // (points to the always 0 slot after the logical frame)
+    uint16_t source[512];
+
+    bool enabled = false;
+};
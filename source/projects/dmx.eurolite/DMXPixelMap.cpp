@@ -0,0 +1,113 @@
+#include "DMXPixelMap.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+DMXPixelMap::DMXPixelMap(LibUSB_EuroliteDMX512USB *device) : device(device)
+{
+}
+
+bool DMXPixelMap::add_strip(int channel, int x, int y, int dx, int dy, int count,
+                            const std::string &order)
+{
+    if (order.empty() || order.find_first_not_of("rgbw") != std::string::npos ||
+        channel < 0 || count <= 0 || channel + count * (int)order.size() > 512)
+        return false;
+    std::lock_guard<std::mutex> lock(pixels_mutex);
+    strips.push_back({channel, x, y, dx, dy, count, order});
+    pixel_count += count;
+    table_valid = false;
+    return true;
+}
+
+void DMXPixelMap::clear()
+{
+    std::lock_guard<std::mutex> lock(pixels_mutex);
+    strips.clear();
+    pixel_count = 0;
+    table_valid = false;
+}
+
+int DMXPixelMap::get_pixel_count()
+{
+    std::lock_guard<std::mutex> lock(pixels_mutex);
+    return pixel_count;
+}
+
+void DMXPixelMap::build_table(int planes, int width, int height, long row_stride)
+{
+    std::vector<uint16_t> channels;
+    std::vector<long> offsets;
+    for (const strip &s : strips)
+        for (int p = 0; p < s.count; p++)
+        {
+            const int x = s.x + p * s.dx;
+            const int y = s.y + p * s.dy;
+            const bool inside = x >= 0 && x < width && y >= 0 && y < height;
+            const long cell = (long)y * row_stride + (long)x * planes;
+            for (size_t c = 0; c < s.order.size(); c++)
+            {
+                // ARGB: alpha (white) is plane 0, RGB: no white plane
+                int plane = -1;
+                switch (s.order[c])
+                {
+                case 'r': plane = planes == 4 ? 1 : 0; break;
+                case 'g': plane = planes == 4 ? 2 : 1; break;
+                case 'b': plane = planes == 4 ? 3 : 2; break;
+                case 'w': plane = planes == 4 ? 0 : -1; break;
+                }
+                channels.push_back((uint16_t)(s.channel + p * s.order.size() + c));
+                offsets.push_back(inside && plane >= 0 ? cell + plane : -1);
+            }
+        }
+
+    // sort by channel, later strips win on overlap
+    std::vector<size_t> index(channels.size());
+    std::iota(index.begin(), index.end(), 0);
+    std::stable_sort(index.begin(), index.end(),
+                     [&channels](size_t a, size_t b) { return channels[a] < channels[b]; });
+    table_channel.clear();
+    table_offset.clear();
+    for (size_t i : index)
+    {
+        if (!table_channel.empty() && table_channel.back() == channels[i])
+            table_offset.back() = offsets[i];
+        else
+        {
+            table_channel.push_back(channels[i]);
+            table_offset.push_back(offsets[i]);
+        }
+    }
+    first_channel = table_channel.empty() ? 0 : table_channel.front();
+    channel_count = table_channel.empty() ? 0 : table_channel.back() - first_channel + 1;
+
+    table_planes = planes;
+    table_width = width;
+    table_height = height;
+    table_row_stride = row_stride;
+    table_valid = true;
+}
+
+bool DMXPixelMap::write_matrix(const unsigned char *data, int planes, int width,
+                               int height, long row_stride)
+{
+    if (!data || (planes != 3 && planes != 4) || width <= 0 || height <= 0)
+        return false;
+    std::lock_guard<std::mutex> lock(pixels_mutex);
+    if (strips.empty())
+        return false;
+    if (!table_valid || planes != table_planes || width != table_width ||
+        height != table_height || row_stride != table_row_stride)
+        build_table(planes, width, height, row_stride);
+
+    const uint16_t *channel = table_channel.data();
+    const long *offset = table_offset.data();
+    const size_t count = table_channel.size();
+    const int first = first_channel;
+    device->write_channels(first, channel_count,
+                           [channel, offset, count, first, data](unsigned char *dest, int) {
+                               for (size_t i = 0; i < count; i++)
+                                   dest[channel[i] - first] = offset[i] >= 0 ? data[offset[i]] : 0;
+                           });
+    return true;
+}
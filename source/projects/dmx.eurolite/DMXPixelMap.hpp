@@ -0,0 +1,83 @@
+/**
+ * Pixel mapping - samples an image (char matrix) into channels
+ * through a gather table built once per matrix layout.
+ * Andrzej Kopeć, 2018
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "libUSB_EuroliteDMX512USB.hpp"
+
+/**
+ * Pixels are mapped in strips: count pixels starting at (x, y), each
+ * next one (dx, dy) further, going to consecutive fixtures from the
+ * first channel. The colour order tells which channels of a fixture
+ * take which colour (e.g. "grb", "rgbw"); w takes the alpha plane of
+ * 4-plane (ARGB) matrices and is 0 for 3-plane (RGB) ones.
+ *
+ * Every pixel write is a table lookup, the table is rebuilt only when
+ * the strips or the matrix layout change. Writes go to the device's
+ * back buffer (logical channels).
+ */
+class DMXPixelMap
+{
+  public:
+    DMXPixelMap(LibUSB_EuroliteDMX512USB *device);
+
+    /** Adds a strip of pixels
+     *
+     *  @param  channel     First channel of the first fixture
+     *  @param  order       Colour order, letters r, g, b and w
+     *  @return false if the order is bad or the strip goes past channel 511
+     */
+    bool add_strip(int channel, int x, int y, int dx, int dy, int count,
+                   const std::string &order);
+
+    void clear();
+
+    int get_pixel_count();
+
+    /** Writes mapped pixels from a char matrix
+     *
+     *  @param  data        First cell
+     *  @param  planes      Planes per cell (3 = RGB, 4 = ARGB)
+     *  @param  row_stride  Bytes between rows
+     *  @return false if nothing is mapped or the layout isn't supported
+     */
+    bool write_matrix(const unsigned char *data, int planes, int width, int height,
+                      long row_stride);
+
+  private:
+    LibUSB_EuroliteDMX512USB *device;
+
+    std::mutex pixels_mutex;
+
+    struct strip
+    {
+        int channel;
+        int x, y, dx, dy;
+        int count;
+        std::string order;
+    };
+    std::vector<strip> strips;
+    int pixel_count = 0;
+
+    // --- gather table for the current layout, entries sorted by channel
+
+    bool table_valid = false;
+    int table_planes = 0;
+    int table_width = 0;
+    int table_height = 0;
+    long table_row_stride = 0;
+    std::vector<uint16_t> table_channel;
+    // byte offset in the matrix, -1 = pixel outside the matrix (0)
+    std::vector<long> table_offset;
+    int first_channel = 0;
+    int channel_count = 0;
+
+    void build_table(int planes, int width, int height, long row_stride);
+};
@@ -0,0 +1,219 @@
+#include "OSC.hpp"
+#include "UDPSocket.hpp"
+
+#include <cstring>
+#include <cstdlib>
+#include <sys/socket.h>
+
+// deepest accepted bundle nesting
+static const int osc_max_depth = 4;
+
+static int32_t read_i32(const unsigned char *p)
+{
+    return (int32_t)(((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3]);
+}
+
+static float read_f32(const unsigned char *p)
+{
+    const int32_t i = read_i32(p);
+    float f;
+    std::memcpy(&f, &i, sizeof(f));
+    return f;
+}
+
+/**
+ * Length of an OSC string including padding, -1 if not terminated.
+ */
+static int osc_string_size(const unsigned char *p, int length)
+{
+    const void *end = std::memchr(p, 0, length);
+    if (!end)
+        return -1;
+    const int size = (int)((const unsigned char *)end - p) + 1;
+    return (size + 3) & ~3;
+}
+
+static unsigned char osc_to_dmx(char type, const unsigned char *p)
+{
+    if (type == 'f')
+    {
+        const float f = read_f32(p);
+        return (unsigned char)(std::max(0.f, std::min(1.f, f)) * 255.f + 0.5f);
+    }
+    return (unsigned char)std::max(0, std::min(255, (int)read_i32(p)));
+}
+
+OSCReceiver::OSCReceiver()
+    : running(false), packet_count(0), error_count(0)
+{
+    std::memset(values, 0, sizeof(values));
+}
+
+OSCReceiver::~OSCReceiver()
+{
+    stop();
+}
+
+bool OSCReceiver::start(unsigned short aport, const std::string &aprefix, const std::string &bind_address)
+{
+    stop();
+    port = aport;
+    prefix = aprefix;
+    std::memset(values, 0, sizeof(values));
+
+    // wake up regularly to check if we should stop
+    sock = udp_open_listener(port, bind_address, 100);
+    if (sock < 0)
+        return false;
+
+    running = true;
+    thread = std::thread(&OSCReceiver::receive_loop, this);
+    return true;
+}
+
+void OSCReceiver::stop()
+{
+    running = false;
+    if (thread.joinable())
+        thread.join();
+    udp_close(sock);
+    layer.reset();
+}
+
+bool OSCReceiver::is_running()
+{
+    return running;
+}
+
+DMXLayer *OSCReceiver::get_layer()
+{
+    return &layer;
+}
+
+unsigned short OSCReceiver::get_port()
+{
+    return port;
+}
+
+unsigned int OSCReceiver::get_packet_count()
+{
+    return packet_count;
+}
+
+unsigned int OSCReceiver::get_error_count()
+{
+    return error_count;
+}
+
+void OSCReceiver::receive_loop()
+{
+    unsigned char packet[4096];
+    while (running)
+    {
+        const ssize_t length = recv(sock, packet, sizeof(packet), 0);
+        if (length <= 0)
+            continue;
+        values_changed = false;
+        if (!handle_element(packet, (int)length, 0))
+            error_count++;
+        packet_count++;
+        // one frame update per datagram (a bundle is a single datagram)
+        if (values_changed)
+        {
+            std::memcpy(layer.write_buffer(), values, 512);
+            layer.publish(512);
+        }
+    }
+}
+
+bool OSCReceiver::handle_element(const unsigned char *data, int length, int depth)
+{
+    if (length < 4 || (length & 3))
+        return false;
+    if (length >= 16 && std::memcmp(data, "#bundle", 8) == 0)
+    {
+        if (depth >= osc_max_depth)
+            return false;
+        // skip "#bundle" and the time tag: values apply immediately
+        int pos = 16;
+        while (pos + 4 <= length)
+        {
+            const int32_t size = read_i32(data + pos);
+            pos += 4;
+            if (size < 0 || pos + size > length ||
+                !handle_element(data + pos, size, depth + 1))
+                return false;
+            pos += size;
+        }
+        return true;
+    }
+    return handle_message(data, length);
+}
+
+bool OSCReceiver::handle_message(const unsigned char *data, int length)
+{
+    const int address_size = osc_string_size(data, length);
+    if (address_size < 0 || address_size >= length)
+        return false;
+    const char *address = (const char *)data;
+    if (std::strncmp(address, prefix.c_str(), prefix.size()) != 0 ||
+        address[prefix.size()] != '/')
+        return true; // not ours
+    const char *method = address + prefix.size() + 1;
+
+    const unsigned char *tags = data + address_size;
+    const int tags_size = osc_string_size(tags, length - address_size);
+    if (tags_size < 0 || tags[0] != ',')
+        return false;
+    const unsigned char *args = tags + tags_size;
+    const unsigned char *end = data + length;
+
+    if (std::strcmp(method, "range") == 0)
+    {
+        if (tags[1] != 'i' || args + 4 > end)
+            return false;
+        int channel = read_i32(args);
+        args += 4;
+        for (const unsigned char *t = tags + 2; *t; t++)
+        {
+            if (*t == 'b')
+            {
+                if (args + 4 > end)
+                    return false;
+                const int32_t size = read_i32(args);
+                args += 4;
+                if (size < 0 || args + size > end)
+                    return false;
+                for (int i = 0; i < size; i++, channel++)
+                    if (channel >= 0 && channel < 512)
+                        values[channel] = args[i];
+                values_changed = true;
+                args += (size + 3) & ~3;
+            }
+            else if (*t == 'i' || *t == 'f')
+            {
+                if (args + 4 > end)
+                    return false;
+                if (channel >= 0 && channel < 512)
+                    values[channel] = osc_to_dmx(*t, args);
+                values_changed = true;
+                channel++;
+                args += 4;
+            }
+            else
+                return false;
+        }
+        return true;
+    }
+
+    // <prefix>/<ch> <value>
+    char *number_end;
+    const long channel = std::strtol(method, &number_end, 10);
+    if (number_end == method || *number_end != '\0' || channel < 0 || channel >= 512)
+        return false;
+    if ((tags[1] != 'i' && tags[1] != 'f') || args + 4 > end)
+        return false;
+    values[channel] = osc_to_dmx(tags[1], args);
+    values_changed = true;
+    return true;
+}
@@ -0,0 +1,84 @@
+/**
+ * OSC receiver writing channel values into a DMX layer
+ * from a network thread.
+ * Andrzej Kopeć, 2018
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <string>
+#include <thread>
+#include "DMXLayer.hpp"
+
+/**
+ * Understood messages (channels are zero based):
+ *  <prefix>/<ch> <value>                 int 0-255 or float 0.-1.
+ *  <prefix>/range <start> <blob>         blob bytes are channel values
+ *  <prefix>/range <start> <v1> [<v2>...] values as above
+ * All messages of a bundle end up in the same frame.
+ */
+class OSCReceiver
+{
+  public:
+    OSCReceiver();
+
+    ~OSCReceiver();
+
+    /** Starts listening
+     *
+     *  @param  port            Local UDP port
+     *  @param  prefix          Address prefix (e.g. "/dmx")
+     *  @param  bind_address    Local IPv4 address to bind to ("" = any)
+     *  @return true if the socket was opened
+     */
+    bool start(unsigned short port, const std::string &prefix = "/dmx",
+               const std::string &bind_address = "");
+
+    void stop();
+
+    bool is_running();
+
+    /**
+     * Layer fed with received values (add it to the device).
+     */
+    DMXLayer *get_layer();
+
+    unsigned short get_port();
+
+    unsigned int get_packet_count();
+
+    unsigned int get_error_count();
+
+  private:
+    DMXLayer layer;
+
+    // channel values as set by OSC so far (network thread only)
+    unsigned char values[512];
+
+    // set when a datagram changed any value
+    bool values_changed = false;
+
+    int sock = -1;
+    unsigned short port = 0;
+    std::string prefix;
+    std::thread thread;
+    std::atomic<bool> running;
+
+    std::atomic<unsigned int> packet_count;
+    std::atomic<unsigned int> error_count;
+
+    /**
+     * Network thread.
+     */
+    void receive_loop();
+
+    /**
+     * Handles a message or a bundle (recursively).
+     * Returns false if the data is malformed.
+     */
+    bool handle_element(const unsigned char *data, int length, int depth);
+
+    bool handle_message(const unsigned char *data, int length);
+};
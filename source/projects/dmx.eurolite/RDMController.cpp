@@ -0,0 +1,356 @@
+#include "RDMController.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+// RDM command classes
+enum
+{
+    RDM_CC_DISCOVERY = 0x10,
+    RDM_CC_DISCOVERY_RESPONSE = 0x11,
+    RDM_CC_GET = 0x20,
+    RDM_CC_GET_RESPONSE = 0x21,
+    RDM_CC_SET = 0x30,
+    RDM_CC_SET_RESPONSE = 0x31
+};
+
+// RDM response types
+enum
+{
+    RDM_RESPONSE_ACK = 0x00,
+    RDM_RESPONSE_ACK_TIMER = 0x01,
+    RDM_RESPONSE_NACK_REASON = 0x02,
+    RDM_RESPONSE_ACK_OVERFLOW = 0x03
+};
+
+// the largest valid device UID (searched by discovery)
+static const uint64_t rdm_max_uid = 0xfffffffffffeull;
+
+static void write_uid(unsigned char *dest, uint64_t uid)
+{
+    for (int i = 0; i < 6; i++)
+        dest[i] = (unsigned char)(uid >> (8 * (5 - i)));
+}
+
+static uint64_t read_uid(const unsigned char *src)
+{
+    uint64_t uid = 0;
+    for (int i = 0; i < 6; i++)
+        uid = (uid << 8) | src[i];
+    return uid;
+}
+
+RDMController::RDMController(RDMTransport *transport, uint64_t source_uid)
+    : transport(transport), source_uid(source_uid)
+{
+}
+
+void RDMController::discover()
+{
+    if (discovering)
+        return;
+    discovering = true;
+    found.clear();
+    branches.clear();
+    branches.push_back(std::make_pair(0ull, rdm_max_uid));
+    push_request(rdm_broadcast_uid, RDM_CC_DISCOVERY, RDM_PID_DISC_UN_MUTE,
+                 NULL, 0, true, false);
+}
+
+void RDMController::get(uint64_t uid, uint16_t pid)
+{
+    push_request(uid, RDM_CC_GET, pid, NULL, 0, false, false);
+}
+
+void RDMController::set(uint64_t uid, uint16_t pid, const unsigned char *data, int length)
+{
+    push_request(uid, RDM_CC_SET, pid, data, length, false, false);
+}
+
+void RDMController::push_request(uint64_t uid, unsigned char command_class, uint16_t pid,
+                                 const unsigned char *data, int length, bool discovery, bool front)
+{
+    request_t r;
+    r.uid = uid;
+    r.command_class = command_class;
+    r.pid = pid;
+    r.data.assign(data, data + std::max(0, std::min(length, 231)));
+    r.discovery = discovery;
+    r.expects_response = (uid != rdm_broadcast_uid || pid == RDM_PID_DISC_UNIQUE_BRANCH);
+    if (front)
+        queue.push_front(r);
+    else
+        queue.push_back(r);
+}
+
+int RDMController::build_packet(const request_t &r, unsigned char *dest)
+{
+    const int pdl = (int)r.data.size();
+    const int message_length = 24 + pdl;
+    dest[0] = 0xcc;                        // start code
+    dest[1] = 0x01;                        // sub start code
+    dest[2] = (unsigned char)message_length; // message length
+    write_uid(dest + 3, r.uid);            // destination UID
+    write_uid(dest + 9, source_uid);       // source UID
+    dest[15] = ++transaction_number;       // transaction number
+    dest[16] = 0x01;                       // port ID
+    dest[17] = 0x00;                       // message count
+    dest[18] = 0x00;                       // sub-device (root)
+    dest[19] = 0x00;
+    dest[20] = r.command_class;            // command class
+    dest[21] = (unsigned char)(r.pid >> 8); // parameter ID
+    dest[22] = (unsigned char)(r.pid & 0xff);
+    dest[23] = (unsigned char)pdl;         // parameter data length
+    if (pdl)
+        std::memcpy(dest + 24, r.data.data(), pdl);
+    unsigned int checksum = 0;
+    for (int i = 0; i < message_length; i++)
+        checksum += dest[i];
+    dest[message_length] = (unsigned char)(checksum >> 8);
+    dest[message_length + 1] = (unsigned char)(checksum & 0xff);
+    return message_length + 2;
+}
+
+void RDMController::tick(uint64_t now_us)
+{
+    if (waiting)
+    {
+        if (now_us - sent_us > response_timeout_us)
+            handle_timeout();
+        return;
+    }
+    if (queue.empty() || !transport->rdm_ready())
+        return;
+
+    current = queue.front();
+    queue.pop_front();
+
+    unsigned char packet[257];
+    const int length = build_packet(current, packet);
+    const bool dub = (current.pid == RDM_PID_DISC_UNIQUE_BRANCH);
+    if (!transport->rdm_send(packet, length, dub))
+    {
+        if (current.discovery)
+        {
+            // can't talk to the line, give up the whole discovery
+            // (queued GET/SET stay, they report their own errors)
+            branches.clear();
+            queue.erase(std::remove_if(queue.begin(), queue.end(),
+                                       [](const request_t &r) { return r.discovery; }),
+                        queue.end());
+            discovery_next_branch();
+        }
+        else
+            complete(RDMResult::ERROR, NULL, 0, 0);
+        return;
+    }
+
+    if (current.expects_response)
+    {
+        waiting = true;
+        sent_us = now_us;
+    }
+    else if (current.discovery) // broadcast un-mute done
+        discovery_next_branch();
+}
+
+void RDMController::handle_response(const unsigned char *data, int length)
+{
+    if (!waiting)
+        return;
+
+    if (current.pid == RDM_PID_DISC_UNIQUE_BRANCH)
+    {
+        waiting = false;
+        uint64_t uid;
+        const int ret = decode_discovery_response(data, length, uid);
+        if (ret == 1 && std::find(found.begin(), found.end(), uid) == found.end())
+        {
+            muting_uid = uid;
+            mute_attempts = 0;
+            push_request(uid, RDM_CC_DISCOVERY, RDM_PID_DISC_MUTE, NULL, 0, true, true);
+            return;
+        }
+        if (ret == 0)
+            branches.pop_back();
+        else
+        {
+            // collision (or a device that ignores mute): split the branch
+            const std::pair<uint64_t, uint64_t> b = branches.back();
+            branches.pop_back();
+            if (b.first < b.second)
+            {
+                const uint64_t mid = b.first + (b.second - b.first) / 2;
+                branches.push_back(std::make_pair(mid + 1, b.second));
+                branches.push_back(std::make_pair(b.first, mid));
+            }
+        }
+        discovery_next_branch();
+        return;
+    }
+
+    // regular RDM response
+    if (length < 26 || data[0] != 0xcc || data[1] != 0x01)
+        return;
+    const int message_length = data[2];
+    if (message_length < 24 || length < message_length + 2)
+        return;
+    unsigned int checksum = 0;
+    for (int i = 0; i < message_length; i++)
+        checksum += data[i];
+    if (checksum != (unsigned int)((data[message_length] << 8) | data[message_length + 1]))
+        return;
+    if (data[15] != transaction_number || read_uid(data + 9) != current.uid)
+        return; // not ours
+    waiting = false;
+
+    const int pdl = std::min((int)data[23], message_length - 24);
+    const unsigned char *pd = data + 24;
+
+    if (current.discovery)
+    {
+        // DISC_MUTE response
+        if (data[20] == RDM_CC_DISCOVERY_RESPONSE && muting_uid == current.uid)
+            found.push_back(muting_uid);
+        discovery_next_branch(); // search the same branch again
+        return;
+    }
+
+    switch (data[16])
+    {
+    case RDM_RESPONSE_ACK:
+    case RDM_RESPONSE_ACK_OVERFLOW:
+        complete(RDMResult::ACK, pd, pdl, 0);
+        break;
+    case RDM_RESPONSE_NACK_REASON:
+        complete(RDMResult::NACK, NULL, 0, pdl >= 2 ? (pd[0] << 8) | pd[1] : 0);
+        break;
+    default: // ACK_TIMER - deferred responses are not supported
+        complete(RDMResult::ERROR, pd, pdl, 0);
+        break;
+    }
+}
+
+void RDMController::handle_timeout()
+{
+    if (!waiting)
+        return;
+    waiting = false;
+    if (current.pid == RDM_PID_DISC_MUTE)
+    {
+        // lost (or broken) mute response, the device is still there
+        if (++mute_attempts < max_mute_attempts)
+        {
+            push_request(muting_uid, RDM_CC_DISCOVERY, RDM_PID_DISC_MUTE, NULL, 0, true, true);
+            return;
+        }
+        // it answers DUB but never mute: keep it, the search splits
+        // branches around it like around a device that ignores mute
+        found.push_back(muting_uid);
+        discovery_next_branch(); // search the same branch again
+    }
+    else if (current.discovery)
+    {
+        // nobody in the branch
+        branches.pop_back();
+        discovery_next_branch();
+    }
+    else
+        complete(RDMResult::TIMEOUT, NULL, 0, 0);
+}
+
+void RDMController::discovery_next_branch()
+{
+    if (branches.empty())
+    {
+        discovering = false;
+        RDMResult r;
+        r.kind = RDMResult::DISCOVERY;
+        r.status = RDMResult::ACK;
+        r.uid = rdm_broadcast_uid;
+        r.pid = RDM_PID_DISC_UNIQUE_BRANCH;
+        r.nack_reason = 0;
+        r.uids = found;
+        results.push_back(r);
+        return;
+    }
+    unsigned char bounds[12];
+    write_uid(bounds, branches.back().first);
+    write_uid(bounds + 6, branches.back().second);
+    push_request(rdm_broadcast_uid, RDM_CC_DISCOVERY, RDM_PID_DISC_UNIQUE_BRANCH,
+                 bounds, 12, true, true);
+}
+
+int RDMController::decode_discovery_response(const unsigned char *data, int length, uint64_t &uid)
+{
+    if (length <= 0)
+        return 0;
+    // up to 7 bytes of 0xFE preamble, 0xAA separator
+    int i = 0;
+    while (i < length && i < 7 && data[i] == 0xfe)
+        i++;
+    if (i >= length || data[i] != 0xaa)
+        return -1;
+    i++;
+    if (length - i < 16)
+        return -1;
+    // EUID: every byte sent twice, as (b | 0xaa) and (b | 0x55)
+    const unsigned char *e = data + i;
+    unsigned int sum = 0;
+    uid = 0;
+    for (int k = 0; k < 12; k++)
+        sum += e[k];
+    for (int k = 0; k < 6; k++)
+        uid = (uid << 8) | (e[2 * k] & e[2 * k + 1]);
+    const unsigned int checksum =
+        ((e[12] & e[13]) << 8) | (e[14] & e[15]);
+    return (checksum == (sum & 0xffff)) ? 1 : -1;
+}
+
+void RDMController::complete(RDMResult::status_t status, const unsigned char *data, int length, uint16_t nack_reason)
+{
+    RDMResult r;
+    r.kind = (current.command_class == RDM_CC_SET) ? RDMResult::SET : RDMResult::GET;
+    r.status = status;
+    r.uid = current.uid;
+    r.pid = current.pid;
+    r.nack_reason = nack_reason;
+    if (data && length > 0)
+        r.data.assign(data, data + length);
+    results.push_back(r);
+}
+
+bool RDMController::poll_result(RDMResult &r)
+{
+    if (results.empty())
+        return false;
+    r = results.front();
+    results.pop_front();
+    return true;
+}
+
+bool RDMController::is_busy()
+{
+    return waiting || discovering || !queue.empty();
+}
+
+void RDMController::uid_to_string(uint64_t uid, char *dest, int size)
+{
+    snprintf(dest, size, "%04x:%08x",
+             (unsigned int)((uid >> 32) & 0xffff), (unsigned int)(uid & 0xffffffff));
+}
+
+bool RDMController::uid_from_string(const char *str, uint64_t &uid)
+{
+    char *end;
+    const unsigned long manufacturer = strtoul(str, &end, 16);
+    if (*end != ':' || manufacturer > 0xffff)
+        return false;
+    const unsigned long long device = strtoull(end + 1, &end, 16);
+    if (*end != '\0' || device > 0xffffffffull)
+        return false;
+    uid = ((uint64_t)manufacturer << 32) | device;
+    return true;
+}
@@ -0,0 +1,212 @@
+/**
+ * Non-blocking RDM (E1.20) controller
+ * discovery (binary search) and GET/SET of basic parameters.
+ * Andrzej Kopeć, 2018
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// RDM parameter IDs handled by the controller
+enum rdm_pid_t
+{
+    RDM_PID_DISC_UNIQUE_BRANCH = 0x0001,
+    RDM_PID_DISC_MUTE = 0x0002,
+    RDM_PID_DISC_UN_MUTE = 0x0003,
+    RDM_PID_DMX_PERSONALITY = 0x00e0,
+    RDM_PID_DMX_START_ADDRESS = 0x00f0,
+    RDM_PID_IDENTIFY_DEVICE = 0x1000
+};
+
+// RDM broadcast UID (all devices)
+static const uint64_t rdm_broadcast_uid = 0xffffffffffffull;
+
+/**
+ * Sends RDM packets to the line.
+ * Implemented by the device (or by a simulated responder).
+ */
+class RDMTransport
+{
+  public:
+    virtual ~RDMTransport() {}
+
+    /** Sends a complete RDM packet (starting with 0xCC start code)
+     *
+     *  @param  packet      Packet data
+     *  @param  length      Packet length
+     *  @param  discovery   True for DISC_UNIQUE_BRANCH requests
+     *                      (response is not a regular RDM packet)
+     *  @return true if the packet was sent
+     */
+    virtual bool rdm_send(const unsigned char *packet, int length, bool discovery) = 0;
+
+    /** False while a packet sent before is still on its way (the
+     *  controller holds the next one back).
+     */
+    virtual bool rdm_ready() { return true; }
+};
+
+/**
+ * Result of an RDM operation, as reported to the user.
+ */
+struct RDMResult
+{
+    enum kind_t
+    {
+        DISCOVERY,
+        GET,
+        SET
+    };
+
+    enum status_t
+    {
+        ACK,
+        NACK,
+        TIMEOUT,
+        ERROR
+    };
+
+    kind_t kind;
+    status_t status;
+    uint64_t uid;
+    uint16_t pid;
+
+    // NACK reason code or response parameter data
+    uint16_t nack_reason;
+    std::vector<unsigned char> data;
+
+    // discovered UIDs (DISCOVERY only)
+    std::vector<uint64_t> uids;
+};
+
+class RDMController
+{
+  public:
+    /**
+     *  @param  transport   Packet transport (not owned)
+     *  @param  source_uid  UID of this controller
+     */
+    RDMController(RDMTransport *transport, uint64_t source_uid = 0x7ff000000001ull);
+
+    /**
+     * Starts full discovery (unmutes all devices, then binary search).
+     */
+    void discover();
+
+    /** Queues a GET command
+     *
+     *  @param  uid     Target device
+     *  @param  pid     Parameter ID
+     */
+    void get(uint64_t uid, uint16_t pid);
+
+    /** Queues a SET command
+     *
+     *  @param  uid     Target device
+     *  @param  pid     Parameter ID
+     *  @param  data    Parameter data
+     *  @param  length  Parameter data length
+     */
+    void set(uint64_t uid, uint16_t pid, const unsigned char *data, int length);
+
+    /**
+     * Sends the next queued packet or handles timeout of the pending one.
+     * Should be called regularly (at most one packet is sent per call).
+     */
+    void tick(uint64_t now_us);
+
+    /**
+     * Passes a packet received from the line (regular response
+     * or discovery response) to the controller.
+     */
+    void handle_response(const unsigned char *data, int length);
+
+    /**
+     * Called when the transport reports that no response arrived.
+     */
+    void handle_timeout();
+
+    /**
+     * Returns true and fills r if there is a pending result.
+     */
+    bool poll_result(RDMResult &r);
+
+    /**
+     * True if there is anything queued or waiting for a response.
+     */
+    bool is_busy();
+
+    /**
+     * Formats uid as "mmmm:dddddddd".
+     */
+    static void uid_to_string(uint64_t uid, char *dest, int size);
+
+    /**
+     * Parses "mmmm:dddddddd", returns false if it is not a valid UID.
+     */
+    static bool uid_from_string(const char *str, uint64_t &uid);
+
+  private:
+    struct request_t
+    {
+        uint64_t uid;
+        unsigned char command_class;
+        uint16_t pid;
+        std::vector<unsigned char> data;
+        // part of discovery (results are consumed by the discovery logic)
+        bool discovery;
+        // broadcasts get no response
+        bool expects_response;
+    };
+
+    RDMTransport *transport;
+    uint64_t source_uid;
+    unsigned char transaction_number = 0;
+
+    // time to wait for a response (us)
+    static const uint64_t response_timeout_us = 30000;
+
+    std::deque<request_t> queue;
+    bool waiting = false;
+    request_t current;
+    uint64_t sent_us = 0;
+
+    std::deque<RDMResult> results;
+
+    // --- discovery state
+
+    bool discovering = false;
+    std::vector<std::pair<uint64_t, uint64_t> > branches;
+    std::vector<uint64_t> found;
+    uint64_t muting_uid = 0;
+    int mute_attempts = 0;
+
+    // DISC_MUTE is repeated this many times before giving up
+    static const int max_mute_attempts = 3;
+
+    /**
+     * Builds an RDM packet from request into dest, returns its length.
+     */
+    int build_packet(const request_t &r, unsigned char *dest);
+
+    /**
+     * Issues DISC_UNIQUE_BRANCH for the branch on top of the stack
+     * or finishes discovery.
+     */
+    void discovery_next_branch();
+
+    /**
+     * Decodes a DISC_UNIQUE_BRANCH response.
+     *
+     *  @return 1 if a valid UID was decoded, 0 if nothing came, -1 on collision
+     */
+    static int decode_discovery_response(const unsigned char *data, int length, uint64_t &uid);
+
+    void complete(RDMResult::status_t status, const unsigned char *data, int length, uint16_t nack_reason);
+
+    void push_request(uint64_t uid, unsigned char command_class, uint16_t pid,
+                      const unsigned char *data, int length, bool discovery, bool front);
+};
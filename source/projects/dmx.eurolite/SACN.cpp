@@ -0,0 +1,233 @@
+#include "SACN.hpp"
+#include "UDPSocket.hpp"
+
+#include <cstring>
+#include <sys/socket.h>
+
+// E1.31 data packet layout
+static const int sacn_min_packet_size = 126;
+static const int sacn_offset_root_vector = 18;
+static const int sacn_offset_cid = 22;
+static const int sacn_offset_frame_vector = 40;
+static const int sacn_offset_priority = 108;
+static const int sacn_offset_sequence = 111;
+static const int sacn_offset_options = 112;
+static const int sacn_offset_universe = 113;
+static const int sacn_offset_dmp_vector = 117;
+static const int sacn_offset_count = 123;
+static const int sacn_offset_start_code = 125;
+
+static const unsigned char acn_packet_identifier[12] = {
+    'A', 'S', 'C', '-', 'E', '1', '.', '1', '7', 0, 0, 0};
+
+// options flags
+static const unsigned char sacn_option_preview = 0x80;
+static const unsigned char sacn_option_terminated = 0x40;
+
+static uint32_t read_u32(const unsigned char *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+SACNReceiver::SACNReceiver()
+    : running(false), packet_count(0), dropped_count(0), source_count(0)
+{
+    std::memset(sources, 0, sizeof(sources));
+}
+
+SACNReceiver::~SACNReceiver()
+{
+    stop();
+}
+
+bool SACNReceiver::start(unsigned short auniverse, const std::string &interface_address)
+{
+    stop();
+    if (auniverse < 1 || auniverse > 63999)
+        return false;
+    universe = auniverse;
+    std::memset(sources, 0, sizeof(sources));
+    source_count = 0;
+
+    // wake up regularly to check if we should stop and for source timeouts
+    sock = udp_open_listener(sacn_port, "", 100);
+    if (sock < 0)
+        return false;
+    // multicast group 239.255.<universe hi>.<universe lo>
+    if (!udp_join_multicast(sock, 0xefff0000u | universe, interface_address))
+    {
+        udp_close(sock);
+        return false;
+    }
+
+    running = true;
+    thread = std::thread(&SACNReceiver::receive_loop, this);
+    return true;
+}
+
+void SACNReceiver::stop()
+{
+    running = false;
+    if (thread.joinable())
+        thread.join();
+    udp_close(sock); // leaves the group as well
+    layer.reset();
+}
+
+bool SACNReceiver::is_running()
+{
+    return running;
+}
+
+DMXLayer *SACNReceiver::get_layer()
+{
+    return &layer;
+}
+
+unsigned short SACNReceiver::get_universe()
+{
+    return universe;
+}
+
+unsigned int SACNReceiver::get_packet_count()
+{
+    return packet_count;
+}
+
+unsigned int SACNReceiver::get_dropped_count()
+{
+    return dropped_count;
+}
+
+int SACNReceiver::get_source_count()
+{
+    return source_count;
+}
+
+void SACNReceiver::receive_loop()
+{
+    unsigned char packet[sacn_offset_start_code + 513];
+    while (running)
+    {
+        const ssize_t length = recv(sock, packet, sizeof(packet), 0);
+        const uint64_t now = DMXLayer::now_us();
+        bool changed = (length > 0) && handle_packet(packet, (int)length, now);
+
+        // expire silent sources
+        for (int i = 0; i < max_sources; i++)
+            if (sources[i].active && now - sources[i].last_us > source_timeout_us)
+            {
+                sources[i].active = false;
+                changed = true;
+            }
+
+        if (changed)
+            merge_sources();
+    }
+}
+
+bool SACNReceiver::handle_packet(const unsigned char *packet, int length, uint64_t now)
+{
+    if (length < sacn_min_packet_size)
+        return false;
+    if (std::memcmp(packet + 4, acn_packet_identifier, 12) != 0 ||
+        read_u32(packet + sacn_offset_root_vector) != 0x00000004 || // VECTOR_ROOT_E131_DATA
+        read_u32(packet + sacn_offset_frame_vector) != 0x00000002 || // VECTOR_E131_DATA_PACKET
+        packet[sacn_offset_dmp_vector] != 0x02)                      // VECTOR_DMP_SET_PROPERTY
+        return false;
+    if (((packet[sacn_offset_universe] << 8) | packet[sacn_offset_universe + 1]) != universe)
+        return false;
+
+    const unsigned char options = packet[sacn_offset_options];
+    if (options & sacn_option_preview)
+        return false;
+
+    // only NULL start code data is merged; other start codes (0xDD
+    // priority...) must not claim or refresh a source
+    if (packet[sacn_offset_start_code] != 0)
+        return false;
+
+    // find the source by CID, or a free slot for a new one
+    const unsigned char *cid = packet + sacn_offset_cid;
+    int found = -1, free_slot = -1;
+    for (int i = 0; i < max_sources && found < 0; i++)
+    {
+        if (sources[i].active && std::memcmp(sources[i].cid, cid, 16) == 0)
+            found = i;
+        else if (!sources[i].active && free_slot < 0)
+            free_slot = i;
+    }
+
+    if (options & sacn_option_terminated)
+    {
+        if (found < 0)
+            return false;
+        sources[found].active = false;
+        return true;
+    }
+
+    const unsigned char sequence = packet[sacn_offset_sequence];
+    if (found >= 0)
+    {
+        // E1.31 6.7.2: discard if -20 < (new - last) <= 0
+        const signed char diff = (signed char)(sequence - sources[found].sequence);
+        if (diff <= 0 && diff > -20)
+        {
+            dropped_count++;
+            return false;
+        }
+    }
+    else if (free_slot >= 0)
+    {
+        found = free_slot;
+        std::memcpy(sources[found].cid, cid, 16);
+        sources[found].active = true;
+    }
+    else
+    {
+        dropped_count++;
+        return false;
+    }
+
+    source_t &s = sources[found];
+    s.sequence = sequence;
+    s.priority = std::min<unsigned char>(packet[sacn_offset_priority], 200);
+    s.last_us = now;
+    const int count = ((packet[sacn_offset_count] << 8) | packet[sacn_offset_count + 1]) - 1;
+    s.size = (unsigned short)std::max(0, std::min(std::min(count, 512), length - sacn_offset_start_code - 1));
+    std::memcpy(s.slots, packet + sacn_offset_start_code + 1, s.size);
+    packet_count++;
+    return true;
+}
+
+void SACNReceiver::merge_sources()
+{
+    int top_priority = -1;
+    int count = 0;
+    for (int i = 0; i < max_sources; i++)
+        if (sources[i].active)
+        {
+            top_priority = std::max(top_priority, (int)sources[i].priority);
+            count++;
+        }
+    source_count = count;
+    if (count == 0)
+    {
+        layer.reset();
+        return;
+    }
+
+    unsigned char *out = layer.write_buffer();
+    unsigned short size = 0;
+    std::memset(out, 0, 512);
+    for (int i = 0; i < max_sources; i++)
+    {
+        const source_t &s = sources[i];
+        if (!s.active || s.priority != top_priority)
+            continue;
+        for (int k = 0; k < s.size; k++)
+            out[k] = std::max(out[k], s.slots[k]);
+        size = std::max(size, s.size);
+    }
+    layer.publish(size);
+}
@@ -0,0 +1,103 @@
+/**
+ * sACN (ANSI E1.31) receiver
+ * multicast universe subscription, per-source priority and sequence
+ * handling, merge of multiple sources into a DMX layer.
+ * Andrzej Kopeć, 2018
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <string>
+#include <thread>
+#include "DMXLayer.hpp"
+
+// sACN UDP port
+static const unsigned short sacn_port = 5568;
+
+class SACNReceiver
+{
+  public:
+    SACNReceiver();
+
+    ~SACNReceiver();
+
+    /** Subscribes to a universe and starts listening
+     *
+     *  @param  universe            Universe number (1-63999)
+     *  @param  interface_address   Local interface IPv4 address ("" = default)
+     *  @return true if the socket was opened and the group joined
+     */
+    bool start(unsigned short universe, const std::string &interface_address = "");
+
+    void stop();
+
+    bool is_running();
+
+    /**
+     * Layer fed with merged frames (add it to the device).
+     */
+    DMXLayer *get_layer();
+
+    unsigned short get_universe();
+
+    unsigned int get_packet_count();
+
+    unsigned int get_dropped_count();
+
+    /**
+     * Count of sources currently merged.
+     */
+    int get_source_count();
+
+  private:
+    // most sources tracked at once (further ones are ignored)
+    static const int max_sources = 8;
+
+    // a source is lost when silent for this long (E1.31 network data loss)
+    static const uint64_t source_timeout_us = 2500000;
+
+    struct source_t
+    {
+        bool active;
+        unsigned char cid[16];
+        unsigned char priority;
+        unsigned char sequence;
+        uint64_t last_us;
+        unsigned short size;
+        unsigned char slots[512];
+    };
+
+    // accessed by the network thread only
+    source_t sources[max_sources];
+
+    DMXLayer layer;
+
+    int sock = -1;
+    std::thread thread;
+    std::atomic<bool> running;
+
+    unsigned short universe = 1;
+
+    std::atomic<unsigned int> packet_count;
+    std::atomic<unsigned int> dropped_count;
+    std::atomic<int> source_count;
+
+    /**
+     * Network thread.
+     */
+    void receive_loop();
+
+    /**
+     * Parses a datagram and updates the source it came from.
+     * Returns true if merged output should be recalculated.
+     */
+    bool handle_packet(const unsigned char *packet, int length, uint64_t now);
+
+    /**
+     * Merges active sources (highest priority wins, HTP between
+     * sources of equal priority) and publishes the result.
+     */
+    void merge_sources();
+};
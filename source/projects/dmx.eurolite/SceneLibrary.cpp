@@ -0,0 +1,201 @@
+#include "SceneLibrary.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static const size_t header_size = sizeof(DMXSceneFileHeader);
+static const size_t record_size = sizeof(DMXSceneRecord);
+
+static bool write_all(int fd, const void *buf, size_t size, off_t offset)
+{
+    const char *p = (const char *)buf;
+    while (size > 0)
+    {
+        const ssize_t n = pwrite(fd, p, size, offset);
+        if (n <= 0)
+            return false;
+        p += n;
+        size -= n;
+        offset += n;
+    }
+    return true;
+}
+
+static bool sync_file(int fd)
+{
+#ifdef F_FULLFSYNC
+    // macOS: fsync doesn't flush the drive cache
+    if (fcntl(fd, F_FULLFSYNC) == 0)
+        return true;
+#endif
+    return fsync(fd) == 0;
+}
+
+static std::string record_name(const DMXSceneRecord *r)
+{
+    // a damaged or foreign file may lack the terminating zero
+    return std::string(r->name, strnlen(r->name, sizeof(r->name)));
+}
+
+SceneLibrary::SceneLibrary()
+{
+}
+
+SceneLibrary::~SceneLibrary()
+{
+    close();
+}
+
+bool SceneLibrary::open(const std::string &apath)
+{
+    close();
+    fd = ::open(apath.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+        return false;
+
+    DMXSceneFileHeader header;
+    const ssize_t n = pread(fd, &header, header_size, 0);
+    if (n == 0)
+    {
+        // new library
+        std::memset(&header, 0, header_size);
+        header.magic = dmx_scene_file_magic;
+        header.version = dmx_scene_file_version;
+        header.record_size = record_size;
+        if (!write_all(fd, &header, header_size, 0) || !sync_file(fd))
+        {
+            close();
+            return false;
+        }
+    }
+    else if (n != (ssize_t)header_size || header.magic != dmx_scene_file_magic ||
+             header.version != dmx_scene_file_version || header.record_size != record_size)
+    {
+        close();
+        return false;
+    }
+
+    // records past the end of the file (shouldn't happen) are dropped
+    struct stat st;
+    if (fstat(fd, &st) < 0)
+    {
+        close();
+        return false;
+    }
+    count = (uint32_t)std::min<uint64_t>(header.record_count, (st.st_size - header_size) / record_size);
+    path = apath;
+    if (!remap())
+    {
+        close();
+        return false;
+    }
+    names.clear();
+    for (uint32_t i = 0; i < count; i++)
+        names[record_name(record(i))] = i;
+    return true;
+}
+
+void SceneLibrary::close()
+{
+    if (map)
+        munmap(map, map_size);
+    map = NULL;
+    map_size = 0;
+    if (fd >= 0)
+        ::close(fd);
+    fd = -1;
+    count = 0;
+    names.clear();
+}
+
+bool SceneLibrary::is_open()
+{
+    return fd >= 0;
+}
+
+bool SceneLibrary::remap()
+{
+    if (map)
+        munmap(map, map_size);
+    map_size = header_size + count * record_size;
+    void *p = mmap(NULL, map_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED)
+    {
+        map = NULL;
+        map_size = 0;
+        return false;
+    }
+    map = (unsigned char *)p;
+    return true;
+}
+
+const DMXSceneRecord *SceneLibrary::record(int index)
+{
+    return (const DMXSceneRecord *)(map + header_size + index * record_size);
+}
+
+int SceneLibrary::save(const std::string &name, LibUSB_EuroliteDMX512USB *device)
+{
+    if (fd < 0 || name.empty() || name.size() >= sizeof(DMXSceneRecord::name))
+        return -1;
+    DMXSceneRecord r;
+    std::memset(&r, 0, record_size);
+    std::memcpy(r.name, name.data(), name.size());
+    device->get_channels(r.slots);
+
+    // record first, then the count that makes it visible
+    const uint32_t new_count = count + 1;
+    if (!write_all(fd, &r, record_size, header_size + count * record_size) ||
+        !sync_file(fd) ||
+        !write_all(fd, &new_count, sizeof(new_count), offsetof(DMXSceneFileHeader, record_count)) ||
+        !sync_file(fd))
+        return -1;
+    count = new_count;
+    if (!remap())
+    {
+        close();
+        return -1;
+    }
+    names[name] = count - 1;
+    return count - 1;
+}
+
+bool SceneLibrary::recall(int index, LibUSB_EuroliteDMX512USB *device)
+{
+    if (!map || index < 0 || index >= (int)count)
+        return false;
+    device->set_channel_memcpy_from(0, 512, const_cast<uint8_t *>(record(index)->slots));
+    return true;
+}
+
+bool SceneLibrary::recall(const std::string &name, LibUSB_EuroliteDMX512USB *device)
+{
+    return recall(find(name), device);
+}
+
+int SceneLibrary::find(const std::string &name)
+{
+    std::map<std::string, int>::const_iterator it = names.find(name);
+    return it == names.end() ? -1 : it->second;
+}
+
+int SceneLibrary::get_count()
+{
+    return (int)count;
+}
+
+std::string SceneLibrary::get_name(int index)
+{
+    if (!map || index < 0 || index >= (int)count)
+        return "";
+    return record_name(record(index));
+}
+
+const std::string &SceneLibrary::get_path()
+{
+    return path;
+}
@@ -0,0 +1,106 @@
+/**
+ * Scene library - binary file of stored universes, memory-mapped
+ * for instant recall.
+ * Andrzej Kopeć, 2018
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include "libUSB_EuroliteDMX512USB.hpp"
+
+/**
+ * File layout (native byte order):
+ *  header (64 bytes), then fixed size records one after another.
+ *
+ * The file only grows: a record is written and synced first, the
+ * record count in the header is updated (and synced) after it, so
+ * a crash leaves at most an unused tail which the next save
+ * overwrites. A name saved again gets a new record, the last one wins.
+ */
+struct DMXSceneFileHeader
+{
+    // 'DMXS' and layout version
+    uint32_t magic;
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t record_count;
+    uint8_t reserved[48];
+};
+
+struct DMXSceneRecord
+{
+    // zero terminated (and padded)
+    char name[32];
+    uint8_t slots[512];
+};
+
+static const uint32_t dmx_scene_file_magic = 0x53584d44; // 'DMXS'
+static const uint32_t dmx_scene_file_version = 1;
+
+class SceneLibrary
+{
+  public:
+    SceneLibrary();
+
+    ~SceneLibrary();
+
+    /** Opens (creates if missing) a library file
+     *
+     *  @param  path    File path
+     *  @return false if the file can't be opened or isn't a library
+     */
+    bool open(const std::string &path);
+
+    void close();
+
+    bool is_open();
+
+    /** Appends the device's back buffer as a scene
+     *
+     *  @param  name    Scene name (up to 31 characters)
+     *  @return         Index of the scene, -1 on failure (a longer
+     *                  name is an error too)
+     */
+    int save(const std::string &name, LibUSB_EuroliteDMX512USB *device);
+
+    /**
+     * Copies a scene into the device's back buffer.
+     */
+    bool recall(int index, LibUSB_EuroliteDMX512USB *device);
+
+    bool recall(const std::string &name, LibUSB_EuroliteDMX512USB *device);
+
+    /**
+     * Index of the latest scene with the name, -1 if there is none.
+     */
+    int find(const std::string &name);
+
+    int get_count();
+
+    std::string get_name(int index);
+
+    const std::string &get_path();
+
+  private:
+    std::string path;
+    int fd = -1;
+
+    // mapping of the header and all committed records
+    unsigned char *map = NULL;
+    size_t map_size = 0;
+
+    uint32_t count = 0;
+
+    // name -> latest index
+    std::map<std::string, int> names;
+
+    /**
+     * Maps the file up to the committed count.
+     */
+    bool remap();
+
+    const DMXSceneRecord *record(int index);
+};
@@ -0,0 +1,100 @@
+#include "SharedMemory.hpp"
+
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+SharedMemoryFrame::SharedMemoryFrame()
+{
+}
+
+SharedMemoryFrame::~SharedMemoryFrame()
+{
+    stop();
+}
+
+bool SharedMemoryFrame::start(const std::string &aname, mode_t mode)
+{
+    stop();
+    int fd = shm_open(aname.c_str(), O_CREAT | O_RDWR, mode);
+    if (fd < 0)
+        return false;
+    // the writer layer goes to the live output: no access beyond mode,
+    // whatever the umask or an earlier creator left
+    if (fchmod(fd, mode) < 0 || ftruncate(fd, sizeof(DMXSharedMemoryLayout)) < 0)
+    {
+        close(fd);
+        return false;
+    }
+    void *p = mmap(NULL, sizeof(DMXSharedMemoryLayout), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd); // mapping stays valid
+    if (p == MAP_FAILED)
+        return false;
+
+    name = aname;
+    shm = (DMXSharedMemoryLayout *)p;
+    std::memset(shm, 0, sizeof(DMXSharedMemoryLayout));
+    shm->version = dmx_shared_memory_version;
+    shm->out_size = 512;
+    __atomic_store_n(&shm->magic, dmx_shared_memory_magic, __ATOMIC_RELEASE);
+    frame_count = 0;
+    in_generation_seen = 0;
+    return true;
+}
+
+void SharedMemoryFrame::stop()
+{
+    if (!shm)
+        return;
+    munmap(shm, sizeof(DMXSharedMemoryLayout));
+    shm_unlink(name.c_str());
+    shm = NULL;
+    layer.reset();
+}
+
+bool SharedMemoryFrame::is_running()
+{
+    return shm != NULL;
+}
+
+DMXLayer *SharedMemoryFrame::get_layer()
+{
+    return &layer;
+}
+
+void SharedMemoryFrame::frame_sent(const unsigned char *slots, int size)
+{
+    if (!shm)
+        return;
+    const uint32_t generation = shm->out_generation;
+    __atomic_store_n(&shm->out_generation, generation + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    shm->out_size = (uint32_t)std::min(size, 512);
+    shm->out_frame_count = ++frame_count;
+    shm->out_timestamp_us = DMXLayer::now_us();
+    std::memcpy(shm->out_slots, slots, std::min(size, 512));
+    __atomic_store_n(&shm->out_generation, generation + 2, __ATOMIC_RELEASE);
+}
+
+void SharedMemoryFrame::frame_will_build()
+{
+    if (!shm)
+        return;
+    const uint32_t g1 = __atomic_load_n(&shm->in_generation, __ATOMIC_ACQUIRE);
+    if (g1 == in_generation_seen || (g1 & 1))
+        return; // nothing new, or being written (try next frame)
+
+    const uint32_t size = std::min<uint32_t>(shm->in_size, 512);
+    std::memcpy(layer.write_buffer(), shm->in_slots, size);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&shm->in_generation, __ATOMIC_RELAXED) != g1)
+        return; // torn, try next frame
+
+    in_generation_seen = g1;
+    if (size == 0)
+        layer.reset();
+    else
+        layer.publish((unsigned short)size);
+}
@@ -0,0 +1,96 @@
+/**
+ * Shared memory frame interface
+ * publishes transmitted frames to other local processes and merges
+ * a frame written by an external process.
+ * Andrzej Kopeć, 2018
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <sys/types.h>
+#include "DMXLayer.hpp"
+#include "libUSB_EuroliteDMX512USB.hpp"
+
+/**
+ * Layout of the POSIX shared memory segment (native byte order).
+ *
+ * Both frames are guarded by a generation counter (seqlock): the writer
+ * increments it to an odd value, writes the data, then increments it to
+ * an even value. A reader copies the data between two reads of the
+ * counter and retries if the values differ or are odd.
+ */
+struct DMXSharedMemoryLayout
+{
+    // 'DMXE' and layout version
+    uint32_t magic;
+    uint32_t version;
+
+    // --- transmitted frame (written by the device)
+    uint32_t out_generation;
+    uint32_t out_size;
+    uint64_t out_frame_count;
+    uint64_t out_timestamp_us;
+    uint8_t out_slots[512];
+
+    // --- external layer (written by another process, merged HTP)
+    uint32_t in_generation;
+    // count of valid slots, 0 disables the layer
+    uint32_t in_size;
+    uint64_t in_timestamp_us;
+    uint8_t in_slots[512];
+};
+
+static const uint32_t dmx_shared_memory_magic = 0x444d5845; // 'DMXE'
+static const uint32_t dmx_shared_memory_version = 1;
+
+class SharedMemoryFrame : public DMXFrameListener
+{
+  public:
+    SharedMemoryFrame();
+
+    ~SharedMemoryFrame();
+
+    /** Creates (or opens) the segment and maps it
+     *
+     *  @param  name    Segment name, e.g. "/dmx_eurolite"
+     *  @param  mode    Permissions, owner and group by default (other
+     *                  processes need the same user or group)
+     *  @return true on success
+     */
+    bool start(const std::string &name, mode_t mode = 0660);
+
+    /**
+     * Unmaps and removes the segment.
+     */
+    void stop();
+
+    bool is_running();
+
+    /**
+     * Layer fed by the external writer (add it to the device).
+     */
+    DMXLayer *get_layer();
+
+    /**
+     * Publishes the transmitted frame to the segment.
+     */
+    void frame_sent(const unsigned char *slots, int size) override;
+
+    /**
+     * Takes a consistent snapshot of the external frame into the layer.
+     */
+    void frame_will_build() override;
+
+  private:
+    DMXLayer layer;
+
+    std::string name;
+    DMXSharedMemoryLayout *shm = NULL;
+
+    uint64_t frame_count = 0;
+
+    // last generation of the external frame taken into the layer
+    uint32_t in_generation_seen = 0;
+};
@@ -0,0 +1,84 @@
+#include "UDPSocket.hpp"
+
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+int udp_open_listener(unsigned short port, const std::string &bind_address, int timeout_ms)
+{
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0)
+        return -1;
+
+    // no SO_REUSEPORT: it spreads datagrams over all sockets on the
+    // port, so every receiver would miss part of the frames
+    int yes = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    struct timeval tv = {timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (!bind_address.empty() && inet_pton(AF_INET, bind_address.c_str(), &addr.sin_addr) != 1)
+    {
+        close(sock);
+        return -1;
+    }
+    if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+int udp_open_sender(const std::string &bind_address)
+{
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0)
+        return -1;
+
+    int yes = 1;
+    setsockopt(sock, SOL_SOCKET, SO_BROADCAST, &yes, sizeof(yes));
+    // never wait for the network, senders drop instead
+    fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+
+    if (!bind_address.empty())
+    {
+        struct sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = 0;
+        if (inet_pton(AF_INET, bind_address.c_str(), &addr.sin_addr) != 1 ||
+            bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+        {
+            close(sock);
+            return -1;
+        }
+    }
+    return sock;
+}
+
+bool udp_join_multicast(int sock, unsigned int group, const std::string &interface_address)
+{
+    struct ip_mreq mreq;
+    std::memset(&mreq, 0, sizeof(mreq));
+    mreq.imr_multiaddr.s_addr = htonl(group);
+    mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+    if (!interface_address.empty())
+        inet_pton(AF_INET, interface_address.c_str(), &mreq.imr_interface);
+    return setsockopt(sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) == 0;
+}
+
+void udp_close(int &sock)
+{
+    if (sock >= 0)
+        close(sock);
+    sock = -1;
+}
@@ -0,0 +1,40 @@
+/**
+ * Small helpers for UDP sockets used by network inputs/outputs.
+ * Andrzej Kopeć, 2018
+ */
+
+#pragma once
+
+#include <string>
+
+/** Opens a UDP socket bound to a local port. Other sockets may share
+ *  the port (SO_REUSEADDR): each of them gets all broadcast and
+ *  multicast datagrams, unicast ones reach only one socket.
+ *
+ *  @param  port            Local port
+ *  @param  bind_address    Local IPv4 address ("" = any)
+ *  @param  timeout_ms      Receive timeout (so threads can check if they should stop)
+ *  @return socket descriptor or -1
+ */
+int udp_open_listener(unsigned short port, const std::string &bind_address, int timeout_ms);
+
+/** Opens a non-blocking UDP socket for sending (broadcast allowed)
+ *
+ *  @param  bind_address    Local IPv4 address of the interface to send from ("" = any)
+ *  @return socket descriptor or -1
+ */
+int udp_open_sender(const std::string &bind_address);
+
+/** Joins an IPv4 multicast group
+ *
+ *  @param  sock            Socket
+ *  @param  group           Group address (host byte order)
+ *  @param  interface_address Local interface IPv4 address ("" = default)
+ *  @return true on success
+ */
+bool udp_join_multicast(int sock, unsigned int group, const std::string &interface_address);
+
+/**
+ * Closes socket (if open) and sets it to -1.
+ */
+void udp_close(int &sock);
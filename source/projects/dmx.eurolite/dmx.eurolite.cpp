@@ -9,8 +9,25 @@
 #include <string>
 #include <vector>
 #include <array>
+#include <algorithm>
 #include "c74_max.h"
+#include "c74_jitter.h"
 #include "libUSB_EuroliteDMX512USB.hpp"
+#include "RDMController.hpp"
+#include "ArtNet.hpp"
+#include "SACN.hpp"
+#include "OSC.hpp"
+#include "SharedMemory.hpp"
+#include "DMXFader.hpp"
+#include "DMXCueStack.hpp"
+#include "SceneLibrary.hpp"
+#include "DMXEffects.hpp"
+#include "DMXPatch.hpp"
+#include "DMXMasters.hpp"
+#include "DMXCurves.hpp"
+#include "DMXFixtures.hpp"
+#include "DMXPixelMap.hpp"
+#include "DMXColorConverter.hpp"
 
 using namespace c74::max;
 
@@ -20,12 +37,146 @@ struct t_dmx_eurolite
 {
   t_object ob;
   LibUSB_EuroliteDMX512USB *dmx;
+  RDMController *rdm;
+  DMXFader *fader;
+  DMXCueStack *cues;
+  SceneLibrary *scenes;
+  DMXEffects *effects;
+  DMXColorConverter *colors;
+  DMXMasters *masters;
+  DMXPatch *patch;
+  DMXCurves *curves;
+  DMXFixtures *fixtures;
+  // symbol of each compiled attribute number
+  std::vector<t_symbol *> *fixture_attributes;
+  DMXPixelMap *pixels;
+  t_symbol *scene_file;
+  ArtNetReceiver *artnet;
+  long artnet_universe;
+  ArtNetSender *artnet_out;
+  long artnet_out_universe;
+  t_symbol *artnet_out_host;
+  SACNReceiver *sacn;
+  long sacn_universe;
+  OSCReceiver *osc;
+  long osc_port;
+  t_symbol *osc_prefix;
+  SharedMemoryFrame *shm;
+  t_symbol *shm_name;
   t_qelem *sync_qelem;
   t_qelem *async_qelem;
+  t_qelem *input_qelem;
+  t_clock *input_clock;
+  void *input_outlet;
+  long input_mode;
+  long byte_order;
+};
+
+// polling interval for DMX input (ms)
+static const double input_poll_interval = 5.;
+
+enum
+{
+  INPUT_OFF,
+  INPUT_REPORT,
+  INPUT_MERGE,
+  INPUT_BOTH
 };
 
 static t_class *this_class = nullptr;
 static t_symbol *sym_readnoly = gensym("readonly");
+static t_symbol *sym_frame = gensym("frame");
+static t_symbol *sym_change = gensym("change");
+static t_symbol *sym_dictionary = gensym("dictionary");
+static t_symbol *sym_scene = gensym("scene");
+static t_symbol *sym_effect = gensym("effect");
+static t_symbol *sym_curveassign16 = gensym("curveassign16");
+
+// RDM parameters addressable by name
+static const struct
+{
+  const char *name;
+  uint16_t pid;
+} rdm_parameters[] = {
+    {"address", RDM_PID_DMX_START_ADDRESS},
+    {"personality", RDM_PID_DMX_PERSONALITY},
+    {"identify", RDM_PID_IDENTIFY_DEVICE}};
+
+static bool rdm_pid_from_symbol(t_symbol *s, uint16_t &pid)
+{
+  for (size_t i = 0; i < sizeof(rdm_parameters) / sizeof(rdm_parameters[0]); i++)
+    if (strcmp(s->s_name, rdm_parameters[i].name) == 0)
+    {
+      pid = rdm_parameters[i].pid;
+      return true;
+    }
+  return false;
+}
+
+static const char *rdm_pid_name(uint16_t pid)
+{
+  for (size_t i = 0; i < sizeof(rdm_parameters) / sizeof(rdm_parameters[0]); i++)
+    if (rdm_parameters[i].pid == pid)
+      return rdm_parameters[i].name;
+  return "unknown";
+}
+
+// Output RDM result as a dictionary
+static void rdm_output_result(t_dmx_eurolite *self, const RDMResult &r)
+{
+  static const char *status_names[] = {"ack", "nack", "timeout", "error"};
+  char uid[16];
+  t_dictionary *d = dictionary_new();
+
+  if (r.kind == RDMResult::DISCOVERY)
+  {
+    dictionary_appendsym(d, gensym("command"), gensym("discovery"));
+    std::vector<t_atom> uids(r.uids.size());
+    for (size_t i = 0; i < r.uids.size(); i++)
+    {
+      RDMController::uid_to_string(r.uids[i], uid, sizeof(uid));
+      atom_setsym(&uids[i], gensym(uid));
+    }
+    dictionary_appendatoms(d, gensym("uids"), (long)uids.size(), uids.data());
+  }
+  else
+  {
+    RDMController::uid_to_string(r.uid, uid, sizeof(uid));
+    dictionary_appendsym(d, gensym("command"),
+                         gensym(r.kind == RDMResult::SET ? "set" : "get"));
+    dictionary_appendsym(d, gensym("uid"), gensym(uid));
+    dictionary_appendsym(d, gensym("parameter"), gensym(rdm_pid_name(r.pid)));
+    if (r.status == RDMResult::NACK)
+      dictionary_appendlong(d, gensym("reason"), r.nack_reason);
+    if (r.status == RDMResult::ACK && !r.data.empty())
+    {
+      if (r.pid == RDM_PID_DMX_START_ADDRESS && r.data.size() >= 2)
+        dictionary_appendlong(d, gensym("value"), (r.data[0] << 8) | r.data[1]);
+      else if (r.pid == RDM_PID_DMX_PERSONALITY && r.data.size() >= 2)
+      {
+        dictionary_appendlong(d, gensym("value"), r.data[0]);
+        dictionary_appendlong(d, gensym("count"), r.data[1]);
+      }
+      else if (r.pid == RDM_PID_IDENTIFY_DEVICE)
+        dictionary_appendlong(d, gensym("value"), r.data[0]);
+      else
+      {
+        std::vector<t_atom> data(r.data.size());
+        for (size_t i = 0; i < r.data.size(); i++)
+          atom_setlong(&data[i], r.data[i]);
+        dictionary_appendatoms(d, gensym("data"), (long)data.size(), data.data());
+      }
+    }
+  }
+  dictionary_appendsym(d, gensym("status"), gensym(status_names[r.status]));
+
+  t_symbol *name = NULL;
+  d = dictobj_register(d, &name);
+  t_atom a;
+  atom_setsym(&a, name);
+  outlet_anything(self->input_outlet, sym_dictionary, 1, &a);
+  dictobj_release(d);
+}
 
 // QElem tasks
 void sync_transfer_qtask(t_dmx_eurolite *self)
@@ -38,25 +189,144 @@ void async_transfer_qtask(t_dmx_eurolite *self)
   self->dmx->service_async_transfer();
 }
 
+void input_qtask(t_dmx_eurolite *self)
+{
+  static t_atom frame_atoms[513];
+  self->dmx->service_input();
+  const DMXInputFrame *f;
+  while ((f = self->dmx->input_frame_peek()) != NULL)
+  {
+    if (f->start_code == 0)
+    {
+      for (int i = 0; i < f->size; i++)
+        atom_setlong(frame_atoms + i, f->slots[i]);
+      outlet_anything(self->input_outlet, sym_frame, f->size, frame_atoms);
+    }
+    self->dmx->input_frame_release();
+  }
+
+  // sparse changes go out as one "change <ch> <val> [<ch> <val>...]" list
+  static DMXInputChange changes[256];
+  static t_atom change_atoms[512];
+  int n;
+  while ((n = self->dmx->input_changes_read(changes, 256)) > 0)
+  {
+    for (int i = 0; i < n; i++)
+    {
+      atom_setlong(change_atoms + 2 * i, changes[i].channel);
+      atom_setlong(change_atoms + 2 * i + 1, changes[i].value);
+    }
+    outlet_anything(self->input_outlet, sym_change, 2 * n, change_atoms);
+  }
+
+  RDMResult result;
+  while (self->rdm->poll_result(result))
+    rdm_output_result(self, result);
+}
+
+// Clock task (scheduler thread) - input is serviced in the main thread
+void input_clock_task(t_dmx_eurolite *self)
+{
+  qelem_set(self->input_qelem);
+  if (self->input_mode != INPUT_OFF || self->rdm->is_busy())
+    clock_fdelay(self->input_clock, input_poll_interval);
+}
+
 void *dmx_eurolite_new(t_symbol *name, long argc, t_atom *argv)
 {
   t_dmx_eurolite *self = (t_dmx_eurolite *)object_alloc(this_class);
 
   self->dmx = new LibUSB_EuroliteDMX512USB();
+  self->rdm = new RDMController(self->dmx);
+  self->fader = new DMXFader(self->dmx);
+  self->dmx->add_frame_listener(self->fader);
+  self->cues = new DMXCueStack(self->dmx);
+  self->dmx->add_frame_listener(self->cues);
+  self->scenes = new SceneLibrary();
+  self->effects = new DMXEffects();
+  self->dmx->add_frame_listener(self->effects);
+  // colour conversion fills whole fixtures before they are scaled
+  self->colors = new DMXColorConverter();
+  self->dmx->add_frame_listener(self->colors);
+  // masters scale logical channels, before the patch
+  self->masters = new DMXMasters();
+  self->dmx->add_frame_listener(self->masters);
+  // the patch maps the finished logical frame, keep it after the effects
+  self->patch = new DMXPatch();
+  self->dmx->add_frame_listener(self->patch);
+  // curves are per physical slot, last
+  self->curves = new DMXCurves();
+  self->dmx->add_frame_listener(self->curves);
+  self->fixtures = new DMXFixtures(self->dmx);
+  self->fixture_attributes = new std::vector<t_symbol *>();
+  self->pixels = new DMXPixelMap(self->dmx);
+  self->scene_file = gensym("");
+  self->artnet = new ArtNetReceiver();
+  self->artnet_universe = 0;
+  self->artnet_out = new ArtNetSender();
+  self->artnet_out_universe = 0;
+  self->artnet_out_host = gensym("255.255.255.255");
+  self->sacn = new SACNReceiver();
+  self->sacn_universe = 1;
+  self->osc = new OSCReceiver();
+  self->osc_port = 8000;
+  self->osc_prefix = gensym("/dmx");
+  self->shm = new SharedMemoryFrame();
+  self->shm_name = gensym("/dmx_eurolite");
   self->dmx->set_timeout(150);
+  self->input_mode = INPUT_OFF;
+  self->byte_order = 0;
 
-  attr_args_process(self, argc, argv);
+  self->input_outlet = outlet_new(self, NULL);
 
   self->sync_qelem = qelem_new(self, (method)sync_transfer_qtask);
   self->async_qelem = qelem_new(self, (method)async_transfer_qtask);
+  self->input_qelem = qelem_new(self, (method)input_qtask);
+  self->input_clock = clock_new(self, (method)input_clock_task);
+
+  attr_args_process(self, argc, argv);
 
   return self;
 }
 
 void dmx_eurolite_free(t_dmx_eurolite *self)
 {
+  clock_unset(self->input_clock);
+  object_free(self->input_clock);
+  qelem_free(self->input_qelem);
   qelem_free(self->sync_qelem);
   qelem_free(self->async_qelem);
+  self->dmx->set_rdm_controller(NULL);
+  self->dmx->remove_layer(self->artnet->get_layer());
+  delete self->artnet;
+  self->dmx->remove_layer(self->sacn->get_layer());
+  delete self->sacn;
+  self->dmx->remove_frame_listener(self->artnet_out);
+  delete self->artnet_out;
+  self->dmx->remove_layer(self->osc->get_layer());
+  delete self->osc;
+  self->dmx->remove_frame_listener(self->shm);
+  self->dmx->remove_layer(self->shm->get_layer());
+  delete self->shm;
+  self->dmx->remove_frame_listener(self->fader);
+  delete self->fader;
+  self->dmx->remove_frame_listener(self->cues);
+  delete self->cues;
+  delete self->scenes;
+  self->dmx->remove_frame_listener(self->effects);
+  delete self->effects;
+  self->dmx->remove_frame_listener(self->colors);
+  delete self->colors;
+  self->dmx->remove_frame_listener(self->masters);
+  delete self->masters;
+  self->dmx->remove_frame_listener(self->patch);
+  delete self->patch;
+  self->dmx->remove_frame_listener(self->curves);
+  delete self->curves;
+  delete self->fixtures;
+  delete self->fixture_attributes;
+  delete self->pixels;
+  delete self->rdm;
   delete self->dmx;
 }
 
@@ -82,6 +352,78 @@ void dmx_eurolite_close(t_dmx_eurolite *self)
   object_attr_touch((t_object *)self, sym_readnoly);
 }
 
+void dmx_eurolite_getparams(t_dmx_eurolite *self)
+{
+  if (!self->dmx->request_widget_parameters())
+    object_error((t_object *)self, "can't read widget parameters");
+  object_attr_touch((t_object *)self, gensym("breaktime"));
+  object_attr_touch((t_object *)self, gensym("mabtime"));
+  object_attr_touch((t_object *)self, gensym("outputrate"));
+  object_attr_touch((t_object *)self, gensym("framerate"));
+}
+
+/**
+ * rdm discover
+ * rdm get <uid> <parameter>
+ * rdm set <uid> <parameter> <value>
+ * Parameters: address, personality, identify.
+ * Results are output as dictionaries.
+ */
+void dmx_eurolite_rdm(t_dmx_eurolite *self, t_symbol *sym, long argc,
+                      t_atom *argv)
+{
+  if (argc < 1)
+    return;
+  t_symbol *command = atom_getsym(argv);
+  if (command == gensym("discover"))
+    self->rdm->discover();
+  else if ((command == gensym("get") && argc >= 3) ||
+           (command == gensym("set") && argc >= 4))
+  {
+    uint64_t uid;
+    uint16_t pid;
+    if (!RDMController::uid_from_string(atom_getsym(argv + 1)->s_name, uid))
+    {
+      object_error((t_object *)self, "rdm: invalid uid %s (use mmmm:dddddddd)",
+                   atom_getsym(argv + 1)->s_name);
+      return;
+    }
+    if (!rdm_pid_from_symbol(atom_getsym(argv + 2), pid))
+    {
+      object_error((t_object *)self, "rdm: unknown parameter %s",
+                   atom_getsym(argv + 2)->s_name);
+      return;
+    }
+    if (command == gensym("get"))
+      self->rdm->get(uid, pid);
+    else
+    {
+      const long value = atom_getlong(argv + 3);
+      unsigned char data[2];
+      if (pid == RDM_PID_DMX_START_ADDRESS)
+      {
+        const long address = clamp(value, 1L, 512L);
+        data[0] = (unsigned char)(address >> 8);
+        data[1] = (unsigned char)(address & 0xff);
+        self->rdm->set(uid, pid, data, 2);
+      }
+      else
+      {
+        data[0] = (unsigned char)clamp(value, 0L, 255L);
+        self->rdm->set(uid, pid, data, 1);
+      }
+    }
+  }
+  else
+  {
+    object_error((t_object *)self, "rdm: bad message");
+    return;
+  }
+  // attach on first use, RDM responses need the IN endpoint
+  self->dmx->set_rdm_controller(self->rdm);
+  clock_fdelay(self->input_clock, input_poll_interval);
+}
+
 void dmx_eurolite_clear(t_dmx_eurolite *self)
 {
   self->dmx->clear_all_channels();
@@ -96,6 +438,24 @@ void dmx_eurolite_postinfo(t_dmx_eurolite *self)
               "ASYNC submit status: %s\n"
               "ASYNC trasfer(cb) status: %s\n"
               "ASYNC event handling status: %s\n"
+              "INPUT enabled: %s\n"
+              "INPUT transfer status: %s\n"
+              "INPUT overruns: %u\n"
+              "Art-Net: %s, universe %d, packets %u, dropped %u\n"
+              "sACN: %s, universe %d, sources %d, packets %u, dropped %u\n"
+              "Art-Net out: %s, universe %d, packets %u, dropped %u\n"
+              "OSC: %s, port %d, packets %u, errors %u\n"
+              "Fades running: %d\n"
+              "Cues: %d, current %d%s\n"
+              "Scenes: %s, %d records\n"
+              "Effects running: %d\n"
+              "Grand master: %.2f\n"
+              "Patch: %s, %d slots patched\n"
+              "Curves: %d slots\n"
+              "Fixtures: %d\n"
+              "Pixels mapped: %d\n"
+              "Colour converted fixtures: %d\n"
+              "Firmware: %d.%d, break %d us, MAB %d us, rate %d\n"
               "DMX buffer: %s \n",
               (self->dmx->is_ready() ? "" : "not"),
               self->dmx->get_sync_transfer_status_name(),
@@ -103,6 +463,45 @@ void dmx_eurolite_postinfo(t_dmx_eurolite *self)
               self->dmx->get_async_submit_status_name(),
               self->dmx->get_async_transfer_status_name(),
               self->dmx->get_async_event_status_name(),
+              (self->dmx->get_input_enabled() ? "YES" : "NO"),
+              self->dmx->get_input_transfer_status_name(),
+              self->dmx->get_input_overruns(),
+              (self->artnet->is_running() ? "on" : "off"),
+              (int)self->artnet->get_port_address(),
+              self->artnet->get_packet_count(),
+              self->artnet->get_dropped_count(),
+              (self->sacn->is_running() ? "on" : "off"),
+              (int)self->sacn->get_universe(),
+              self->sacn->get_source_count(),
+              self->sacn->get_packet_count(),
+              self->sacn->get_dropped_count(),
+              (self->artnet_out->is_running() ? "on" : "off"),
+              (int)self->artnet_out->get_port_address(),
+              self->artnet_out->get_packet_count(),
+              self->artnet_out->get_dropped_count(),
+              (self->osc->is_running() ? "on" : "off"),
+              (int)self->osc->get_port(),
+              self->osc->get_packet_count(),
+              self->osc->get_error_count(),
+              self->fader->get_active_count(),
+              self->cues->get_cue_count(),
+              self->cues->get_current(),
+              (self->cues->is_fading() ? " (fading)" : ""),
+              (self->scenes->is_open() ? self->scenes->get_path().c_str() : "none"),
+              self->scenes->get_count(),
+              self->effects->get_count(),
+              self->masters->get_grand_master(),
+              (self->patch->is_enabled() ? "on" : "off"),
+              self->patch->get_patched_count(),
+              self->curves->get_assigned_count(),
+              self->fixtures->get_fixture_count(),
+              self->pixels->get_pixel_count(),
+              self->colors->get_fixture_count(),
+              self->dmx->get_firmware_version() >> 8,
+              self->dmx->get_firmware_version() & 0xff,
+              self->dmx->get_break_time_us(),
+              self->dmx->get_mab_time_us(),
+              self->dmx->get_output_rate(),
               self->dmx->get_channels_as_string().c_str());
 }
 
@@ -111,6 +510,24 @@ void dmx_eurolite_setchannel(t_dmx_eurolite *self, long ch, long val)
   self->dmx->set_channel(
       ch, static_cast<unsigned char>(std::max(0l, std::min(255l, val))));
 }
+/**
+ * Converts atoms to channel values in a single pass: ints and floats are
+ * clamped to 0-255 (floats truncated like atom_getlong), others give 0.
+ */
+static void atoms_to_channels(const t_atom *argv, unsigned char *dest, int count)
+{
+  for (int i = 0; i < count; i++)
+  {
+    const t_atom *a = argv + i;
+    long v = 0;
+    if (a->a_type == A_LONG)
+      v = (long)std::max<t_atom_long>(0, std::min<t_atom_long>(255, a->a_w.w_long));
+    else if (a->a_type == A_FLOAT && a->a_w.w_float > 0) // NaN fails too
+      v = (long)std::min<t_atom_float>(255, a->a_w.w_float);
+    dest[i] = (unsigned char)v;
+  }
+}
+
 /**
  *
  * This method goes along the lines of "set" in builtin [table] object:
@@ -121,87 +538,1327 @@ void dmx_eurolite_set(t_dmx_eurolite *self, t_symbol *sym, long argc,
 {
   if (argc < 2)
     return;
-  if (argc > 513)
-    argc = 513;
   const int first = atom_getlong(argv);
-  const int data_count = argc - 1;
-  std::array<unsigned char, 512> data;
-  for (int i = 0; i < data_count; i++)
+  self->dmx->write_channels(first, argc - 1, [argv](unsigned char *dest, int count) {
+    atoms_to_channels(argv + 1, dest, count);
+  });
+}
+
+/**
+ * Plain list: <val1> [<val2>...] from channel 0
+ */
+void dmx_eurolite_list(t_dmx_eurolite *self, t_symbol *sym, long argc,
+                       t_atom *argv)
+{
+  self->dmx->write_channels(0, argc, [argv](unsigned char *dest, int count) {
+    atoms_to_channels(argv, dest, count);
+  });
+}
+
+/**
+ * Normalised values: setf <ch_num> <val1> [<val2>...], values 0.-1.
+ */
+void dmx_eurolite_setf(t_dmx_eurolite *self, t_symbol *sym, long argc,
+                       t_atom *argv)
+{
+  if (argc < 2)
+    return;
+  const int first = atom_getlong(argv);
+  const int count = std::min(512L, argc - 1);
+  float values[512];
+  for (int i = 0; i < count; i++)
   {
-    data[i] =
-        static_cast<unsigned char>(clamp((int)atom_getlong(argv + i + 1), 0, 255));
+    const t_atom *a = argv + 1 + i;
+    values[i] = a->a_type == A_FLOAT ? (float)a->a_w.w_float
+                                     : (a->a_type == A_LONG ? (float)a->a_w.w_long : 0.f);
   }
-  self->dmx->set_channel_array_from(first, data_count, data.data());
+  self->dmx->set_channel_float_from(first, count, values);
 }
 
-void dmx_eurolite_assist(t_dmx_eurolite *self, void *unused,
-                         t_assist_function io, long index, char *string_dest)
+/**
+ * 16-bit values: set16 <ch_num> <val1> [<val2>...], each value (0-65535)
+ * goes to a coarse/fine pair of channels in "byteorder" order.
+ */
+void dmx_eurolite_set16(t_dmx_eurolite *self, t_symbol *sym, long argc,
+                        t_atom *argv)
 {
-  if (io == ASSIST_INLET)
-    strncpy(string_dest, "Message In", ASSIST_STRING_MAXSIZE);
+  if (argc < 2)
+    return;
+  const int first = atom_getlong(argv);
+  const int count = std::min(256L, argc - 1);
+  uint16_t values[256];
+  for (int i = 0; i < count; i++)
+    values[i] = (uint16_t)clamp((long)atom_getlong(argv + 1 + i), 0L, 65535L);
+  self->dmx->set_channel16_from(first, count, values, self->byte_order != 0);
 }
 
-// -- ATTRIBUTES
+/**
+ * fade <ch_num> <target> <time_ms>
+ */
+void dmx_eurolite_fade(t_dmx_eurolite *self, long ch, long target,
+                       double time_ms)
+{
+  const unsigned char value = (unsigned char)clamp(target, 0L, 255L);
+  self->fader->fade((int)ch, 1, &value, time_ms);
+}
 
-t_max_err dmx_eurolite_timeout_set(t_dmx_eurolite *x, t_object *attr, long argc,
-                                   t_atom *argv)
+/**
+ * faderange <ch_num> <count> <target> <time_ms>
+ */
+void dmx_eurolite_faderange(t_dmx_eurolite *self, long ch, long count,
+                            long target, double time_ms)
 {
-  long to = clamp((long)atom_getlong(argv), 20L, 2500L);
-  x->dmx->set_timeout(to);
-  return 0;
+  self->fader->fade_range((int)ch, (int)count,
+                          (unsigned char)clamp(target, 0L, 255L), time_ms);
 }
 
-t_max_err dmx_eurolite_timeout_get(t_dmx_eurolite *x, t_object *attr,
-                                   long *argc, t_atom **argv)
+/**
+ * fadeto <ch_num> <time_ms> <val1> [<val2>...]
+ */
+void dmx_eurolite_fadeto(t_dmx_eurolite *self, t_symbol *sym, long argc,
+                         t_atom *argv)
 {
-  char alloc;
-  atom_alloc(argc, argv, &alloc);
-  atom_setlong(*argv, x->dmx->get_timeout());
-  return 0;
+  if (argc < 3)
+    return;
+  const int first = atom_getlong(argv);
+  const double time_ms = atom_getfloat(argv + 1);
+  const int count = std::min(512L, argc - 2);
+  unsigned char targets[512];
+  atoms_to_channels(argv + 2, targets, count);
+  self->fader->fade(first, count, targets, time_ms);
 }
 
-t_max_err dmx_eurolite_ready_get(t_dmx_eurolite *x, t_object *attr, long *argc,
-                                 t_atom **argv)
+void dmx_eurolite_stopfades(t_dmx_eurolite *self)
 {
-  char alloc;
-  atom_alloc(argc, argv, &alloc);
-  atom_setlong(*argv, (x->dmx->is_ready() ? 1L : 0L));
-  return 0;
+  self->fader->stop();
 }
 
-t_max_err dmx_eurolite_ready_set(t_dmx_eurolite *x, t_object *attr, long argc,
-                                 t_atom *argv)
+// -- CUES
+
+/**
+ * record [<cue>] - records current values, appends if no cue given
+ */
+void dmx_eurolite_record(t_dmx_eurolite *self, t_symbol *sym, long argc,
+                         t_atom *argv)
 {
-  return 0; // DOES NOTHING
+  const int index = self->cues->record(argc > 0 ? (int)atom_getlong(argv) : -1);
+  object_post((t_object *)self, "recorded cue %d", index);
 }
 
-void ext_main(void *r)
+/**
+ * cuetimes <cue> <in_ms> [<out_ms> [<delay_ms> [<follow_ms>]]]
+ * out time defaults to in time, negative follow time = no follow
+ */
+void dmx_eurolite_cuetimes(t_dmx_eurolite *self, t_symbol *sym, long argc,
+                           t_atom *argv)
 {
-  this_class = class_new("dmx.eurolite", (method)dmx_eurolite_new,
-                         (method)dmx_eurolite_free, sizeof(t_dmx_eurolite), 0L,
-                         A_GIMME,
-                         0);
+  if (argc < 2)
+    return;
+  const double in_ms = atom_getfloat(argv + 1);
+  if (!self->cues->set_times((int)atom_getlong(argv), in_ms,
+                             argc > 2 ? atom_getfloat(argv + 2) : in_ms,
+                             argc > 3 ? atom_getfloat(argv + 3) : 0.,
+                             argc > 4 ? atom_getfloat(argv + 4) : -1.))
+    object_error((t_object *)self, "no cue %ld", (long)atom_getlong(argv));
+}
 
-  class_addmethod(this_class, (method)dmx_eurolite_sync, "sync", 0);
-  class_addmethod(this_class, (method)dmx_eurolite_sync, "async", 0);
-  class_addmethod(this_class, (method)dmx_eurolite_sync, "bang", 0);
+void dmx_eurolite_go(t_dmx_eurolite *self)
+{
+  self->cues->go();
+}
 
-  class_addmethod(this_class, (method)dmx_eurolite_setchannel, "setchannel",
-                  A_DEFLONG, A_DEFLONG, 0);
-  class_addmethod(this_class, (method)dmx_eurolite_set, "set", A_GIMME, 0);
-  class_addmethod(this_class, (method)dmx_eurolite_open, "open", 0);
-  class_addmethod(this_class, (method)dmx_eurolite_close, "close", 0);
-  class_addmethod(this_class, (method)dmx_eurolite_clear, "clear", 0);
-  class_addmethod(this_class, (method)dmx_eurolite_postinfo, "postinfo", 0);
-  class_addmethod(this_class, (method)dmx_eurolite_assist, "assist", A_CANT, 0);
+void dmx_eurolite_back(t_dmx_eurolite *self)
+{
+  self->cues->back();
+}
 
-  CLASS_ATTR_LONG(this_class, "timeout", 0, t_dmx_eurolite, ob);
-  CLASS_ATTR_LABEL(this_class, "timeout", 0, "Transfer timeout (ms)");
-  // does it change anything?	actual limiting happens in accessors
-  CLASS_ATTR_MAX(this_class, "timeout", 0, "2500");
-  CLASS_ATTR_MIN(this_class, "timeout", 0, "25");
-  CLASS_ATTR_ACCESSORS(this_class, "timeout", dmx_eurolite_timeout_get,
-                       dmx_eurolite_timeout_set);
+void dmx_eurolite_goto(t_dmx_eurolite *self, long index)
+{
+  if (index < 0 || index >= self->cues->get_cue_count())
+    object_error((t_object *)self, "no cue %ld", index);
+  self->cues->go_to((int)index);
+}
+
+void dmx_eurolite_deletecue(t_dmx_eurolite *self, long index)
+{
+  if (!self->cues->remove((int)index))
+    object_error((t_object *)self, "no cue %ld", index);
+}
+
+void dmx_eurolite_clearcues(t_dmx_eurolite *self)
+{
+  self->cues->clear();
+}
+
+// -- SCENES
+
+/**
+ * save <name> - appends current values to the scene library
+ */
+void dmx_eurolite_save(t_dmx_eurolite *self, t_symbol *name)
+{
+  if (!self->scenes->is_open())
+  {
+    object_error((t_object *)self, "no scene file, set @scenefile");
+    return;
+  }
+  if (strlen(name->s_name) > 31)
+    object_error((t_object *)self, "scene name %s is longer than 31 characters", name->s_name);
+  else if (self->scenes->save(name->s_name, self->dmx) < 0)
+    object_error((t_object *)self, "can't save scene %s", name->s_name);
+}
+
+/**
+ * recall <name> or recall <index>
+ */
+void dmx_eurolite_recall(t_dmx_eurolite *self, t_symbol *sym, long argc,
+                         t_atom *argv)
+{
+  if (argc < 1)
+    return;
+  const bool found =
+      atom_gettype(argv) == A_SYM
+          ? self->scenes->recall(atom_getsym(argv)->s_name, self->dmx)
+          : self->scenes->recall((int)atom_getlong(argv), self->dmx);
+  if (!found)
+    object_error((t_object *)self, "no such scene");
+}
+
+/**
+ * Outputs "scene <index> <name>" for every scene (latest save of a name only).
+ */
+void dmx_eurolite_scenes(t_dmx_eurolite *self)
+{
+  t_atom a[2];
+  for (int i = 0; i < self->scenes->get_count(); i++)
+  {
+    const std::string name = self->scenes->get_name(i);
+    if (self->scenes->find(name) != i)
+      continue; // saved again later
+    atom_setlong(a, i);
+    atom_setsym(a + 1, gensym(name.c_str()));
+    outlet_anything(self->input_outlet, sym_scene, 2, a);
+  }
+}
+
+// -- EFFECTS
+
+static const struct
+{
+  const char *name;
+  DMXEffect::waveform_t waveform;
+} effect_waveforms[] = {{"sine", DMXEffect::SINE},         {"ramp", DMXEffect::RAMP},
+                        {"triangle", DMXEffect::TRIANGLE}, {"square", DMXEffect::SQUARE},
+                        {"chase", DMXEffect::CHASE},       {"strobe", DMXEffect::STROBE}};
+
+static const struct
+{
+  const char *name;
+  DMXEffect::combine_t combine;
+} effect_combines[] = {{"htp", DMXEffect::COMBINE_HTP},
+                       {"add", DMXEffect::COMBINE_ADD},
+                       {"replace", DMXEffect::COMBINE_REPLACE}};
+
+/**
+ * effect <waveform> <start> <count> <rate_hz> [<depth> [<spread> [<width>]]] [htp|add|replace]
+ * Outputs "effect <id>".
+ */
+void dmx_eurolite_effect(t_dmx_eurolite *self, t_symbol *sym, long argc,
+                         t_atom *argv)
+{
+  if (argc < 4 || atom_gettype(argv) != A_SYM)
+  {
+    object_error((t_object *)self,
+                 "effect <waveform> <start> <count> <rate> [<depth> [<spread> [<width>]]] [htp|add|replace]");
+    return;
+  }
+  int w = 0;
+  const int waveform_count = sizeof(effect_waveforms) / sizeof(effect_waveforms[0]);
+  while (w < waveform_count && strcmp(atom_getsym(argv)->s_name, effect_waveforms[w].name) != 0)
+    w++;
+  if (w == waveform_count)
+  {
+    object_error((t_object *)self, "unknown waveform %s", atom_getsym(argv)->s_name);
+    return;
+  }
+  DMXEffect e = DMXEffects::make(effect_waveforms[w].waveform, (int)atom_getlong(argv + 1),
+                                 (int)atom_getlong(argv + 2), (float)atom_getfloat(argv + 3));
+  // trailing symbol selects how the effect combines with the frame
+  if (atom_gettype(argv + argc - 1) == A_SYM)
+  {
+    t_symbol *mode = atom_getsym(argv + argc - 1);
+    for (size_t i = 0; i < sizeof(effect_combines) / sizeof(effect_combines[0]); i++)
+      if (strcmp(mode->s_name, effect_combines[i].name) == 0)
+        e.combine = effect_combines[i].combine;
+    argc--;
+  }
+  if (argc > 4)
+    e.depth = (float)atom_getfloat(argv + 4);
+  if (argc > 5)
+    e.spread = (float)atom_getfloat(argv + 5);
+  if (argc > 6)
+    e.width = (float)atom_getfloat(argv + 6);
+
+  t_atom id;
+  atom_setlong(&id, self->effects->add(e));
+  outlet_anything(self->input_outlet, sym_effect, 1, &id);
+}
+
+void dmx_eurolite_stopeffect(t_dmx_eurolite *self, long id)
+{
+  if (!self->effects->remove((int)id))
+    object_error((t_object *)self, "no effect %ld", id);
+}
+
+void dmx_eurolite_cleareffects(t_dmx_eurolite *self)
+{
+  self->effects->clear();
+}
+
+// -- MASTERS
+
+/**
+ * master <level> [<time_ms>]
+ */
+void dmx_eurolite_master(t_dmx_eurolite *self, t_symbol *sym, long argc,
+                         t_atom *argv)
+{
+  if (argc < 1)
+    return;
+  self->masters->set_grand_master((float)atom_getfloat(argv),
+                                  argc > 1 ? atom_getfloat(argv + 1) : 0);
+}
+
+/**
+ * submaster <n> <level> [<time_ms>]
+ */
+void dmx_eurolite_submaster(t_dmx_eurolite *self, t_symbol *sym, long argc,
+                            t_atom *argv)
+{
+  if (argc < 2)
+    return;
+  if (!self->masters->set_submaster((int)atom_getlong(argv),
+                                    (float)atom_getfloat(argv + 1),
+                                    argc > 2 ? atom_getfloat(argv + 2) : 0))
+    object_error((t_object *)self, "no submaster %ld (0-%d)",
+                 (long)atom_getlong(argv), DMXMasters::max_submasters - 1);
+}
+
+/**
+ * subassign <n> <start> [<count>], n = -1 releases channels
+ */
+void dmx_eurolite_subassign(t_dmx_eurolite *self, t_symbol *sym, long argc,
+                            t_atom *argv)
+{
+  if (argc < 2)
+    return;
+  if (!self->masters->assign((int)atom_getlong(argv), (int)atom_getlong(argv + 1),
+                             argc > 2 ? (int)atom_getlong(argv + 2) : 1))
+    object_error((t_object *)self, "can't assign channels to submaster %ld",
+                 (long)atom_getlong(argv));
+}
+
+/**
+ * intensity <start> <count> <0|1>
+ */
+void dmx_eurolite_intensity(t_dmx_eurolite *self, long from, long c, long on)
+{
+  self->masters->set_intensity((int)from, (int)c, on != 0);
+}
+
+// -- PATCH
+
+/**
+ * patch <logical> <physical1> [<physical2>...]
+ */
+void dmx_eurolite_patch(t_dmx_eurolite *self, t_symbol *sym, long argc,
+                        t_atom *argv)
+{
+  if (argc < 2)
+    return;
+  const long logical = atom_getlong(argv);
+  for (long i = 1; i < argc; i++)
+    if (!self->patch->patch((int)logical, (int)atom_getlong(argv + i)))
+      object_error((t_object *)self, "can't patch %ld to %ld", logical,
+                   (long)atom_getlong(argv + i));
+}
+
+void dmx_eurolite_unpatch(t_dmx_eurolite *self, long physical)
+{
+  self->patch->unpatch((int)physical);
+}
+
+void dmx_eurolite_clearpatch(t_dmx_eurolite *self)
+{
+  self->patch->clear();
+}
+
+void dmx_eurolite_loadpatch(t_dmx_eurolite *self, t_symbol *path)
+{
+  std::string error;
+  if (!self->patch->load_file(path->s_name, error))
+    object_error((t_object *)self, "%s", error.c_str());
+}
+
+/**
+ * patchdict <name> - keys are logical channels, values physical
+ * slots (a number or a list). Replaces the whole patch.
+ */
+void dmx_eurolite_patchdict(t_dmx_eurolite *self, t_symbol *name)
+{
+  t_dictionary *d = dictobj_findregistered_retain(name);
+  if (!d)
+  {
+    object_error((t_object *)self, "no dictionary %s", name->s_name);
+    return;
+  }
+  int sources[512];
+  for (int i = 0; i < 512; i++)
+    sources[i] = -1;
+  long key_count = 0;
+  t_symbol **keys = NULL;
+  dictionary_getkeys(d, &key_count, &keys);
+  for (long k = 0; k < key_count; k++)
+  {
+    const int logical = atoi(keys[k]->s_name);
+    long argc = 0;
+    t_atom *argv = NULL;
+    dictionary_getatoms(d, keys[k], &argc, &argv);
+    for (long i = 0; i < argc; i++)
+    {
+      const long physical = atom_getlong(argv + i);
+      if (logical >= 0 && logical < 512 && physical >= 0 && physical < 512)
+        sources[physical] = logical;
+      else
+        object_error((t_object *)self, "can't patch %s to %ld", keys[k]->s_name,
+                     physical);
+    }
+  }
+  if (keys)
+    dictionary_freekeys(d, key_count, keys);
+  dictobj_release(d);
+  self->patch->set_table(sources);
+}
+
+// -- CURVES
+
+/**
+ * curve <n> gamma <g>
+ * curve <n> scurve <k>
+ * curve <n> custom <p1> <p2> [<p3>...]
+ */
+void dmx_eurolite_curve(t_dmx_eurolite *self, t_symbol *sym, long argc,
+                        t_atom *argv)
+{
+  if (argc < 3)
+  {
+    object_error((t_object *)self, "curve <n> gamma|scurve|custom <values>");
+    return;
+  }
+  const int curve = (int)atom_getlong(argv);
+  const char *kind = atom_getsym(argv + 1)->s_name;
+  bool done = false;
+  if (strcmp(kind, "gamma") == 0)
+    done = self->curves->set_gamma(curve, (float)atom_getfloat(argv + 2));
+  else if (strcmp(kind, "scurve") == 0)
+    done = self->curves->set_scurve(curve, (float)atom_getfloat(argv + 2));
+  else if (strcmp(kind, "custom") == 0)
+  {
+    const int count = (int)std::min(256L, argc - 2);
+    float points[256];
+    for (int i = 0; i < count; i++)
+      points[i] = (float)atom_getfloat(argv + 2 + i);
+    done = self->curves->set_custom(curve, points, count);
+  }
+  if (!done)
+    object_error((t_object *)self, "can't set curve %d (1-%d) %s", curve,
+                 DMXCurves::max_curves - 1, kind);
+}
+
+/**
+ * curveassign <n> <start> [<count>] - n = 0 back to linear
+ */
+void dmx_eurolite_curveassign(t_dmx_eurolite *self, t_symbol *sym, long argc,
+                              t_atom *argv)
+{
+  if (argc < 2)
+    return;
+  const bool wide = sym == sym_curveassign16;
+  if (!self->curves->assign((int)atom_getlong(argv), (int)atom_getlong(argv + 1),
+                            argc > 2 ? (int)atom_getlong(argv + 2) : 1, wide))
+    object_error((t_object *)self, "can't assign channels to curve %ld",
+                 (long)atom_getlong(argv));
+}
+
+// -- FIXTURES
+
+/**
+ * Reads one attribute of a profile: a channel offset or a list of them
+ * (8-bit), or a dictionary {"offsets": <offset(s)>, "16bit": 1}.
+ */
+static DMXFixtureAttribute attribute_from_dictionary(t_dictionary *profile, t_symbol *key)
+{
+  DMXFixtureAttribute a;
+  a.name = key->s_name;
+  a.wide = false;
+  t_dictionary *entry = profile;
+  t_symbol *offsets_key = key;
+  if (dictionary_entryisdictionary(profile, key))
+  {
+    dictionary_getdictionary(profile, key, (t_object **)&entry);
+    offsets_key = gensym("offsets");
+    t_atom_long wide = 0;
+    dictionary_getlong(entry, gensym("16bit"), &wide);
+    a.wide = wide != 0;
+  }
+  long argc = 0;
+  t_atom *argv = NULL;
+  dictionary_getatoms(entry, offsets_key, &argc, &argv);
+  for (long i = 0; i < argc; i++)
+    a.offsets.push_back((int)atom_getlong(argv + i));
+  return a;
+}
+
+/**
+ * Loads {"profiles": {<name>: {<attribute>: ...}},
+ *        "fixtures": {<number>: [<profile>, <address>]}}
+ * and compiles it, replacing all fixtures.
+ */
+static void fixtures_from_dictionary(t_dmx_eurolite *self, t_dictionary *d)
+{
+  // the rig in use stays until the new one compiles
+  DMXFixtures *fixtures = self->fixtures;
+  fixtures->clear_definitions();
+
+  t_dictionary *profiles = NULL;
+  t_dictionary *numbers = NULL;
+  if (dictionary_getdictionary(d, gensym("profiles"), (t_object **)&profiles) != MAX_ERR_NONE ||
+      dictionary_getdictionary(d, gensym("fixtures"), (t_object **)&numbers) != MAX_ERR_NONE)
+  {
+    object_error((t_object *)self, "fixtures need \"profiles\" and \"fixtures\"");
+    return;
+  }
+
+  long key_count = 0;
+  t_symbol **keys = NULL;
+  dictionary_getkeys(profiles, &key_count, &keys);
+  for (long k = 0; k < key_count; k++)
+  {
+    t_dictionary *attributes = NULL;
+    DMXFixtureProfile profile;
+    profile.name = keys[k]->s_name;
+    if (dictionary_getdictionary(profiles, keys[k], (t_object **)&attributes) == MAX_ERR_NONE)
+    {
+      long attribute_count = 0;
+      t_symbol **attribute_keys = NULL;
+      dictionary_getkeys(attributes, &attribute_count, &attribute_keys);
+      for (long i = 0; i < attribute_count; i++)
+        profile.attributes.push_back(attribute_from_dictionary(attributes, attribute_keys[i]));
+      if (attribute_keys)
+        dictionary_freekeys(attributes, attribute_count, attribute_keys);
+    }
+    if (!fixtures->add_profile(profile))
+      object_error((t_object *)self, "bad profile %s", keys[k]->s_name);
+  }
+  if (keys)
+    dictionary_freekeys(profiles, key_count, keys);
+
+  dictionary_getkeys(numbers, &key_count, &keys);
+  for (long k = 0; k < key_count; k++)
+  {
+    long argc = 0;
+    t_atom *argv = NULL;
+    dictionary_getatoms(numbers, keys[k], &argc, &argv);
+    if (argc < 2 || !fixtures->add_fixture(atoi(keys[k]->s_name), atom_getsym(argv)->s_name,
+                                           (int)atom_getlong(argv + 1)))
+      object_error((t_object *)self, "bad fixture %s", keys[k]->s_name);
+  }
+  if (keys)
+    dictionary_freekeys(numbers, key_count, keys);
+
+  std::string error;
+  if (!fixtures->compile(error))
+  {
+    object_error((t_object *)self, "%s", error.c_str());
+    return;
+  }
+  // messages find attributes by symbol pointer
+  const std::vector<std::string> names = fixtures->get_attribute_names();
+  std::vector<t_symbol *> attributes;
+  for (size_t i = 0; i < names.size(); i++)
+    attributes.push_back(gensym(names[i].c_str()));
+  self->fixture_attributes->swap(attributes);
+}
+
+void dmx_eurolite_fixturedict(t_dmx_eurolite *self, t_symbol *name)
+{
+  t_dictionary *d = dictobj_findregistered_retain(name);
+  if (!d)
+  {
+    object_error((t_object *)self, "no dictionary %s", name->s_name);
+    return;
+  }
+  fixtures_from_dictionary(self, d);
+  dictobj_release(d);
+}
+
+/**
+ * loadfixtures <file> - JSON file in Max search path or absolute
+ */
+void dmx_eurolite_loadfixtures(t_dmx_eurolite *self, t_symbol *file)
+{
+  char filename[MAX_PATH_CHARS];
+  short path = 0;
+  t_dictionary *d = NULL;
+  if (path_frompathname(file->s_name, &path, filename) != 0 ||
+      dictionary_read(filename, path, &d) != MAX_ERR_NONE || !d)
+  {
+    object_error((t_object *)self, "can't read %s", file->s_name);
+    return;
+  }
+  fixtures_from_dictionary(self, d);
+  object_free(d);
+}
+
+/**
+ * fixture <n> <attribute> <value1> [<value2>...], values 0.-1.
+ */
+void dmx_eurolite_fixture(t_dmx_eurolite *self, t_symbol *sym, long argc,
+                          t_atom *argv)
+{
+  if (argc < 3)
+    return;
+  const std::vector<t_symbol *> &attributes = *self->fixture_attributes;
+  t_symbol *name = atom_getsym(argv + 1);
+  const int attribute =
+      (int)(std::find(attributes.begin(), attributes.end(), name) - attributes.begin());
+  const int count = (int)std::min(512L, argc - 2);
+  float values[512];
+  for (int i = 0; i < count; i++)
+    values[i] = (float)atom_getfloat(argv + 2 + i);
+  if (!self->fixtures->set((int)atom_getlong(argv), attribute, values, count))
+    object_error((t_object *)self, "fixture %ld has no %s", (long)atom_getlong(argv),
+                 name->s_name);
+}
+
+// -- PIXEL MAPPING
+
+/**
+ * pixelstrip <channel> <x> <y> <dx> <dy> <count> [<order>]
+ */
+void dmx_eurolite_pixelstrip(t_dmx_eurolite *self, t_symbol *sym, long argc,
+                             t_atom *argv)
+{
+  if (argc < 6)
+  {
+    object_error((t_object *)self, "pixelstrip <channel> <x> <y> <dx> <dy> <count> [<order>]");
+    return;
+  }
+  const char *order = argc > 6 ? atom_getsym(argv + 6)->s_name : "rgb";
+  if (!self->pixels->add_strip((int)atom_getlong(argv), (int)atom_getlong(argv + 1),
+                               (int)atom_getlong(argv + 2), (int)atom_getlong(argv + 3),
+                               (int)atom_getlong(argv + 4), (int)atom_getlong(argv + 5),
+                               order))
+    object_error((t_object *)self, "bad pixel strip (order %s)", order);
+}
+
+void dmx_eurolite_clearpixels(t_dmx_eurolite *self)
+{
+  self->pixels->clear();
+}
+
+/**
+ * jit_matrix <name> - char matrix, 3 (RGB) or 4 (ARGB) planes
+ */
+void dmx_eurolite_jit_matrix(t_dmx_eurolite *self, t_symbol *sym, long argc,
+                             t_atom *argv)
+{
+  if (argc < 1)
+    return;
+  t_symbol *name = atom_getsym(argv);
+  void *matrix = jit_object_findregistered(name);
+  if (!matrix)
+  {
+    object_error((t_object *)self, "no matrix %s", name->s_name);
+    return;
+  }
+  const long lock = (long)jit_object_method(matrix, _jit_sym_lock, 1);
+  t_jit_matrix_info info;
+  unsigned char *data = NULL;
+  jit_object_method(matrix, _jit_sym_getinfo, &info);
+  jit_object_method(matrix, _jit_sym_getdata, &data);
+  if (info.type != _jit_sym_char)
+    object_error((t_object *)self, "pixel mapping needs a char matrix");
+  else
+    self->pixels->write_matrix(data, (int)info.planecount, (int)info.dim[0],
+                               info.dimcount > 1 ? (int)info.dim[1] : 1,
+                               info.dimcount > 1 ? info.dimstride[1] : 0);
+  jit_object_method(matrix, _jit_sym_lock, lock);
+}
+
+// -- COLOUR CONVERSION
+
+static const struct
+{
+  const char *name;
+  DMXColorConverter::input_t input;
+} color_inputs[] = {{"rgb", DMXColorConverter::INPUT_RGB},
+                    {"hsv", DMXColorConverter::INPUT_HSV}};
+
+static const struct
+{
+  const char *name;
+  DMXColorConverter::output_t output;
+} color_outputs[] = {{"rgb", DMXColorConverter::OUTPUT_RGB},
+                     {"rgbw", DMXColorConverter::OUTPUT_RGBW},
+                     {"rgba", DMXColorConverter::OUTPUT_RGBA},
+                     {"rgbaw", DMXColorConverter::OUTPUT_RGBAW}};
+
+/**
+ * colorconvert <channel> <count> <rgb|hsv> <rgb|rgbw|rgba|rgbaw>
+ */
+void dmx_eurolite_colorconvert(t_dmx_eurolite *self, t_symbol *sym, long argc,
+                               t_atom *argv)
+{
+  if (argc < 4)
+  {
+    object_error((t_object *)self, "colorconvert <channel> <count> <input> <output>");
+    return;
+  }
+  const char *input_name = atom_getsym(argv + 2)->s_name;
+  const char *output_name = atom_getsym(argv + 3)->s_name;
+  int input = -1;
+  int output = -1;
+  for (size_t i = 0; i < sizeof(color_inputs) / sizeof(color_inputs[0]); i++)
+    if (strcmp(input_name, color_inputs[i].name) == 0)
+      input = color_inputs[i].input;
+  for (size_t i = 0; i < sizeof(color_outputs) / sizeof(color_outputs[0]); i++)
+    if (strcmp(output_name, color_outputs[i].name) == 0)
+      output = color_outputs[i].output;
+  if (input < 0 || output < 0)
+  {
+    object_error((t_object *)self, "unknown conversion %s to %s", input_name, output_name);
+    return;
+  }
+  if (!self->colors->add((int)atom_getlong(argv), (int)atom_getlong(argv + 1),
+                         (DMXColorConverter::input_t)input,
+                         (DMXColorConverter::output_t)output))
+    object_error((t_object *)self, "fixtures don't fit in the universe");
+}
+
+void dmx_eurolite_clearcolorconvert(t_dmx_eurolite *self)
+{
+  self->colors->clear();
+}
+
+void dmx_eurolite_whitepoint(t_dmx_eurolite *self, double r, double g, double b)
+{
+  self->colors->set_white_point((float)r, (float)g, (float)b);
+}
+
+void dmx_eurolite_amberpoint(t_dmx_eurolite *self, double r, double g, double b)
+{
+  self->colors->set_amber_point((float)r, (float)g, (float)b);
+}
+
+void dmx_eurolite_assist(t_dmx_eurolite *self, void *unused,
+                         t_assist_function io, long index, char *string_dest)
+{
+  if (io == ASSIST_INLET)
+    strncpy(string_dest, "Message In", ASSIST_STRING_MAXSIZE);
+  else
+    strncpy(string_dest, "DMX Input", ASSIST_STRING_MAXSIZE);
+}
+
+// -- ATTRIBUTES
+
+t_max_err dmx_eurolite_timeout_set(t_dmx_eurolite *x, t_object *attr, long argc,
+                                   t_atom *argv)
+{
+  long to = clamp((long)atom_getlong(argv), 20L, 2500L);
+  x->dmx->set_timeout(to);
+  return 0;
+}
+
+t_max_err dmx_eurolite_timeout_get(t_dmx_eurolite *x, t_object *attr,
+                                   long *argc, t_atom **argv)
+{
+  char alloc;
+  atom_alloc(argc, argv, &alloc);
+  atom_setlong(*argv, x->dmx->get_timeout());
+  return 0;
+}
+
+t_max_err dmx_eurolite_input_get(t_dmx_eurolite *x, t_object *attr, long *argc,
+                                 t_atom **argv)
+{
+  char alloc;
+  atom_alloc(argc, argv, &alloc);
+  atom_setlong(*argv, x->input_mode);
+  return 0;
+}
+
+t_max_err dmx_eurolite_input_set(t_dmx_eurolite *x, t_object *attr, long argc,
+                                 t_atom *argv)
+{
+  x->input_mode = clamp((long)atom_getlong(argv), (long)INPUT_OFF, (long)INPUT_BOTH);
+  const bool report = (x->input_mode == INPUT_REPORT || x->input_mode == INPUT_BOTH);
+  const bool merge = (x->input_mode == INPUT_MERGE || x->input_mode == INPUT_BOTH);
+  x->dmx->set_input_report(report);
+  x->dmx->set_input_merge(merge);
+  x->dmx->enable_input(x->input_mode != INPUT_OFF);
+  if (x->input_mode != INPUT_OFF)
+    clock_fdelay(x->input_clock, input_poll_interval);
+  else if (!x->rdm->is_busy())
+    clock_unset(x->input_clock);
+  return 0;
+}
+
+t_max_err dmx_eurolite_onchange_get(t_dmx_eurolite *x, t_object *attr,
+                                    long *argc, t_atom **argv)
+{
+  char alloc;
+  atom_alloc(argc, argv, &alloc);
+  atom_setlong(*argv, (x->dmx->get_input_on_change() ? 1L : 0L));
+  return 0;
+}
+
+t_max_err dmx_eurolite_onchange_set(t_dmx_eurolite *x, t_object *attr,
+                                    long argc, t_atom *argv)
+{
+  x->dmx->set_input_on_change(atom_getlong(argv) != 0);
+  return 0;
+}
+
+t_max_err dmx_eurolite_dither_get(t_dmx_eurolite *x, t_object *attr,
+                                  long *argc, t_atom **argv)
+{
+  char alloc;
+  atom_alloc(argc, argv, &alloc);
+  atom_setlong(*argv, (x->dmx->get_dither() ? 1L : 0L));
+  return 0;
+}
+
+t_max_err dmx_eurolite_dither_set(t_dmx_eurolite *x, t_object *attr,
+                                  long argc, t_atom *argv)
+{
+  x->dmx->set_dither(atom_getlong(argv) != 0);
+  return 0;
+}
+
+t_max_err dmx_eurolite_breaktime_get(t_dmx_eurolite *x, t_object *attr,
+                                     long *argc, t_atom **argv)
+{
+  char alloc;
+  atom_alloc(argc, argv, &alloc);
+  atom_setlong(*argv, x->dmx->get_break_time_us());
+  return 0;
+}
+
+t_max_err dmx_eurolite_breaktime_set(t_dmx_eurolite *x, t_object *attr,
+                                     long argc, t_atom *argv)
+{
+  x->dmx->set_widget_parameters((int)atom_getlong(argv),
+                                x->dmx->get_mab_time_us(),
+                                x->dmx->get_output_rate());
+  return 0;
+}
+
+t_max_err dmx_eurolite_mabtime_get(t_dmx_eurolite *x, t_object *attr,
+                                   long *argc, t_atom **argv)
+{
+  char alloc;
+  atom_alloc(argc, argv, &alloc);
+  atom_setlong(*argv, x->dmx->get_mab_time_us());
+  return 0;
+}
+
+t_max_err dmx_eurolite_mabtime_set(t_dmx_eurolite *x, t_object *attr,
+                                   long argc, t_atom *argv)
+{
+  x->dmx->set_widget_parameters(x->dmx->get_break_time_us(),
+                                (int)atom_getlong(argv),
+                                x->dmx->get_output_rate());
+  return 0;
+}
+
+t_max_err dmx_eurolite_outputrate_get(t_dmx_eurolite *x, t_object *attr,
+                                      long *argc, t_atom **argv)
+{
+  char alloc;
+  atom_alloc(argc, argv, &alloc);
+  atom_setlong(*argv, x->dmx->get_output_rate());
+  return 0;
+}
+
+t_max_err dmx_eurolite_outputrate_set(t_dmx_eurolite *x, t_object *attr,
+                                      long argc, t_atom *argv)
+{
+  x->dmx->set_widget_parameters(x->dmx->get_break_time_us(),
+                                x->dmx->get_mab_time_us(),
+                                (int)atom_getlong(argv));
+  return 0;
+}
+
+t_max_err dmx_eurolite_framerate_get(t_dmx_eurolite *x, t_object *attr,
+                                     long *argc, t_atom **argv)
+{
+  char alloc;
+  atom_alloc(argc, argv, &alloc);
+  const unsigned int period = x->dmx->get_frame_period_us();
+  atom_setfloat(*argv, period ? 1000000. / period : 0.);
+  return 0;
+}
+
+t_max_err dmx_eurolite_artnet_get(t_dmx_eurolite *x, t_object *attr,
+                                  long *argc, t_atom **argv)
+{
+  char alloc;
+  atom_alloc(argc, argv, &alloc);
+  atom_setlong(*argv, (x->artnet->is_running() ? 1L : 0L));
+  return 0;
+}
+
+t_max_err dmx_eurolite_artnet_set(t_dmx_eurolite *x, t_object *attr,
+                                  long argc, t_atom *argv)
+{
+  if (atom_getlong(argv))
+  {
+    if (!x->artnet->start((unsigned short)x->artnet_universe))
+    {
+      object_error((t_object *)x, "can't listen on Art-Net port %d", artnet_port);
+      return MAX_ERR_GENERIC;
+    }
+    x->dmx->add_layer(x->artnet->get_layer());
+  }
+  else
+  {
+    x->dmx->remove_layer(x->artnet->get_layer());
+    x->artnet->stop();
+  }
+  return 0;
+}
+
+t_max_err dmx_eurolite_artnetuniverse_set(t_dmx_eurolite *x, t_object *attr,
+                                          long argc, t_atom *argv)
+{
+  x->artnet_universe = clamp((long)atom_getlong(argv), 0L, 32767L);
+  x->artnet->set_port_address((unsigned short)x->artnet_universe);
+  return 0;
+}
+
+t_max_err dmx_eurolite_artnetout_get(t_dmx_eurolite *x, t_object *attr,
+                                     long *argc, t_atom **argv)
+{
+  char alloc;
+  atom_alloc(argc, argv, &alloc);
+  atom_setlong(*argv, (x->artnet_out->is_running() ? 1L : 0L));
+  return 0;
+}
+
+t_max_err dmx_eurolite_artnetout_set(t_dmx_eurolite *x, t_object *attr,
+                                     long argc, t_atom *argv)
+{
+  x->dmx->remove_frame_listener(x->artnet_out);
+  x->artnet_out->stop();
+  if (atom_getlong(argv))
+  {
+    if (!x->artnet_out->start(x->artnet_out_host->s_name,
+                              (unsigned short)x->artnet_out_universe))
+    {
+      object_error((t_object *)x, "can't send Art-Net to %s",
+                   x->artnet_out_host->s_name);
+      return MAX_ERR_GENERIC;
+    }
+    x->dmx->add_frame_listener(x->artnet_out);
+  }
+  return 0;
+}
+
+t_max_err dmx_eurolite_artnetoutuniverse_set(t_dmx_eurolite *x, t_object *attr,
+                                             long argc, t_atom *argv)
+{
+  x->artnet_out_universe = clamp((long)atom_getlong(argv), 0L, 32767L);
+  x->artnet_out->set_port_address((unsigned short)x->artnet_out_universe);
+  return 0;
+}
+
+t_max_err dmx_eurolite_artnetouthost_set(t_dmx_eurolite *x, t_object *attr,
+                                         long argc, t_atom *argv)
+{
+  x->artnet_out_host = atom_getsym(argv);
+  // reopen if running
+  if (x->artnet_out->is_running())
+  {
+    t_atom on;
+    atom_setlong(&on, 1);
+    return dmx_eurolite_artnetout_set(x, attr, 1, &on);
+  }
+  return 0;
+}
+
+t_max_err dmx_eurolite_osc_get(t_dmx_eurolite *x, t_object *attr, long *argc,
+                               t_atom **argv)
+{
+  char alloc;
+  atom_alloc(argc, argv, &alloc);
+  atom_setlong(*argv, (x->osc->is_running() ? 1L : 0L));
+  return 0;
+}
+
+t_max_err dmx_eurolite_osc_set(t_dmx_eurolite *x, t_object *attr, long argc,
+                               t_atom *argv)
+{
+  x->dmx->remove_layer(x->osc->get_layer());
+  x->osc->stop();
+  if (atom_getlong(argv))
+  {
+    if (!x->osc->start((unsigned short)x->osc_port, x->osc_prefix->s_name))
+    {
+      object_error((t_object *)x, "can't listen for OSC on port %ld",
+                   x->osc_port);
+      return MAX_ERR_GENERIC;
+    }
+    x->dmx->add_layer(x->osc->get_layer());
+  }
+  return 0;
+}
+
+// port and prefix changes restart the listener if running
+t_max_err dmx_eurolite_oscport_set(t_dmx_eurolite *x, t_object *attr,
+                                   long argc, t_atom *argv)
+{
+  x->osc_port = clamp((long)atom_getlong(argv), 1L, 65535L);
+  if (x->osc->is_running())
+  {
+    t_atom on;
+    atom_setlong(&on, 1);
+    return dmx_eurolite_osc_set(x, attr, 1, &on);
+  }
+  return 0;
+}
+
+t_max_err dmx_eurolite_oscprefix_set(t_dmx_eurolite *x, t_object *attr,
+                                     long argc, t_atom *argv)
+{
+  x->osc_prefix = atom_getsym(argv);
+  if (x->osc->is_running())
+  {
+    t_atom on;
+    atom_setlong(&on, 1);
+    return dmx_eurolite_osc_set(x, attr, 1, &on);
+  }
+  return 0;
+}
+
+t_max_err dmx_eurolite_shm_get(t_dmx_eurolite *x, t_object *attr, long *argc,
+                               t_atom **argv)
+{
+  char alloc;
+  atom_alloc(argc, argv, &alloc);
+  atom_setlong(*argv, (x->shm->is_running() ? 1L : 0L));
+  return 0;
+}
+
+t_max_err dmx_eurolite_shm_set(t_dmx_eurolite *x, t_object *attr, long argc,
+                               t_atom *argv)
+{
+  x->dmx->remove_frame_listener(x->shm);
+  x->dmx->remove_layer(x->shm->get_layer());
+  x->shm->stop();
+  if (atom_getlong(argv))
+  {
+    if (!x->shm->start(x->shm_name->s_name))
+    {
+      object_error((t_object *)x, "can't create shared memory %s",
+                   x->shm_name->s_name);
+      return MAX_ERR_GENERIC;
+    }
+    x->dmx->add_frame_listener(x->shm);
+    x->dmx->add_layer(x->shm->get_layer());
+  }
+  return 0;
+}
+
+t_max_err dmx_eurolite_shmname_set(t_dmx_eurolite *x, t_object *attr,
+                                   long argc, t_atom *argv)
+{
+  x->shm_name = atom_getsym(argv);
+  if (x->shm->is_running())
+  {
+    t_atom on;
+    atom_setlong(&on, 1);
+    return dmx_eurolite_shm_set(x, attr, 1, &on);
+  }
+  return 0;
+}
+
+t_max_err dmx_eurolite_scenefile_set(t_dmx_eurolite *x, t_object *attr,
+                                     long argc, t_atom *argv)
+{
+  x->scene_file = atom_getsym(argv);
+  if (x->scene_file->s_name[0] == 0)
+    x->scenes->close();
+  else if (!x->scenes->open(x->scene_file->s_name))
+    object_error((t_object *)x, "can't open scene file %s",
+                 x->scene_file->s_name);
+  return 0;
+}
+
+t_max_err dmx_eurolite_sacn_get(t_dmx_eurolite *x, t_object *attr,
+                                long *argc, t_atom **argv)
+{
+  char alloc;
+  atom_alloc(argc, argv, &alloc);
+  atom_setlong(*argv, (x->sacn->is_running() ? 1L : 0L));
+  return 0;
+}
+
+t_max_err dmx_eurolite_sacn_set(t_dmx_eurolite *x, t_object *attr, long argc,
+                                t_atom *argv)
+{
+  x->dmx->remove_layer(x->sacn->get_layer());
+  x->sacn->stop();
+  if (atom_getlong(argv))
+  {
+    if (!x->sacn->start((unsigned short)x->sacn_universe))
+    {
+      object_error((t_object *)x, "can't subscribe to sACN universe %ld",
+                   x->sacn_universe);
+      return MAX_ERR_GENERIC;
+    }
+    x->dmx->add_layer(x->sacn->get_layer());
+  }
+  return 0;
+}
+
+t_max_err dmx_eurolite_sacnuniverse_set(t_dmx_eurolite *x, t_object *attr,
+                                        long argc, t_atom *argv)
+{
+  x->sacn_universe = clamp((long)atom_getlong(argv), 1L, 63999L);
+  // resubscribe if running
+  if (x->sacn->is_running())
+  {
+    t_atom on;
+    atom_setlong(&on, 1);
+    return dmx_eurolite_sacn_set(x, attr, 1, &on);
+  }
+  return 0;
+}
+
+t_max_err dmx_eurolite_ready_get(t_dmx_eurolite *x, t_object *attr, long *argc,
+                                 t_atom **argv)
+{
+  char alloc;
+  atom_alloc(argc, argv, &alloc);
+  atom_setlong(*argv, (x->dmx->is_ready() ? 1L : 0L));
+  return 0;
+}
+
+t_max_err dmx_eurolite_ready_set(t_dmx_eurolite *x, t_object *attr, long argc,
+                                 t_atom *argv)
+{
+  return 0; // DOES NOTHING
+}
+
+void ext_main(void *r)
+{
+  this_class = class_new("dmx.eurolite", (method)dmx_eurolite_new,
+                         (method)dmx_eurolite_free, sizeof(t_dmx_eurolite), 0L,
+                         A_GIMME,
+                         0);
+
+  class_addmethod(this_class, (method)dmx_eurolite_sync, "sync", 0);
+  class_addmethod(this_class, (method)dmx_eurolite_async, "async", 0);
+  class_addmethod(this_class, (method)dmx_eurolite_sync, "bang", 0);
+
+  class_addmethod(this_class, (method)dmx_eurolite_setchannel, "setchannel",
+                  A_DEFLONG, A_DEFLONG, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_set, "set", A_GIMME, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_list, "list", A_GIMME, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_setf, "setf", A_GIMME, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_set16, "set16", A_GIMME, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_fade, "fade", A_LONG, A_LONG,
+                  A_FLOAT, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_faderange, "faderange",
+                  A_LONG, A_LONG, A_LONG, A_FLOAT, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_fadeto, "fadeto", A_GIMME, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_stopfades, "stopfades", 0);
+  class_addmethod(this_class, (method)dmx_eurolite_record, "record", A_GIMME, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_cuetimes, "cuetimes", A_GIMME, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_go, "go", 0);
+  class_addmethod(this_class, (method)dmx_eurolite_back, "back", 0);
+  class_addmethod(this_class, (method)dmx_eurolite_goto, "goto", A_LONG, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_deletecue, "deletecue", A_LONG, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_clearcues, "clearcues", 0);
+  class_addmethod(this_class, (method)dmx_eurolite_save, "save", A_SYM, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_recall, "recall", A_GIMME, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_scenes, "scenes", 0);
+  class_addmethod(this_class, (method)dmx_eurolite_effect, "effect", A_GIMME, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_stopeffect, "stopeffect", A_LONG, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_cleareffects, "cleareffects", 0);
+  class_addmethod(this_class, (method)dmx_eurolite_master, "master", A_GIMME, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_submaster, "submaster", A_GIMME, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_subassign, "subassign", A_GIMME, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_intensity, "intensity", A_LONG,
+                  A_LONG, A_LONG, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_patch, "patch", A_GIMME, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_unpatch, "unpatch", A_LONG, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_clearpatch, "clearpatch", 0);
+  class_addmethod(this_class, (method)dmx_eurolite_loadpatch, "loadpatch", A_SYM, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_patchdict, "patchdict", A_SYM, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_curve, "curve", A_GIMME, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_fixturedict, "fixturedict", A_SYM, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_loadfixtures, "loadfixtures", A_SYM, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_fixture, "fixture", A_GIMME, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_pixelstrip, "pixelstrip", A_GIMME, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_clearpixels, "clearpixels", 0);
+  class_addmethod(this_class, (method)dmx_eurolite_jit_matrix, "jit_matrix", A_GIMME, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_colorconvert, "colorconvert", A_GIMME, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_clearcolorconvert, "clearcolorconvert", 0);
+  class_addmethod(this_class, (method)dmx_eurolite_whitepoint, "whitepoint", A_FLOAT,
+                  A_FLOAT, A_FLOAT, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_amberpoint, "amberpoint", A_FLOAT,
+                  A_FLOAT, A_FLOAT, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_curveassign, "curveassign", A_GIMME, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_curveassign, "curveassign16", A_GIMME, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_open, "open", 0);
+  class_addmethod(this_class, (method)dmx_eurolite_close, "close", 0);
+  class_addmethod(this_class, (method)dmx_eurolite_clear, "clear", 0);
+  class_addmethod(this_class, (method)dmx_eurolite_getparams, "getparams", 0);
+  class_addmethod(this_class, (method)dmx_eurolite_rdm, "rdm", A_GIMME, 0);
+  class_addmethod(this_class, (method)dmx_eurolite_postinfo, "postinfo", 0);
+  class_addmethod(this_class, (method)dmx_eurolite_assist, "assist", A_CANT, 0);
+
+  CLASS_ATTR_LONG(this_class, "timeout", 0, t_dmx_eurolite, ob);
+  CLASS_ATTR_LABEL(this_class, "timeout", 0, "Transfer timeout (ms)");
+  // does it change anything?	actual limiting happens in accessors
+  CLASS_ATTR_MAX(this_class, "timeout", 0, "2500");
+  CLASS_ATTR_MIN(this_class, "timeout", 0, "25");
+  CLASS_ATTR_ACCESSORS(this_class, "timeout", dmx_eurolite_timeout_get,
+                       dmx_eurolite_timeout_set);
+
+  CLASS_ATTR_LONG(this_class, "input", 0, t_dmx_eurolite, input_mode);
+  CLASS_ATTR_ENUMINDEX(this_class, "input", 0, "off report merge \"report and merge\"");
+  CLASS_ATTR_LABEL(this_class, "input", 0, "DMX input mode");
+  CLASS_ATTR_ACCESSORS(this_class, "input", dmx_eurolite_input_get,
+                       dmx_eurolite_input_set);
+
+  CLASS_ATTR_LONG(this_class, "onchange", 0, t_dmx_eurolite, ob);
+  CLASS_ATTR_STYLE_LABEL(this_class, "onchange", 0, "onoff",
+                         "Receive changed channels only");
+  CLASS_ATTR_ACCESSORS(this_class, "onchange", dmx_eurolite_onchange_get,
+                       dmx_eurolite_onchange_set);
+
+  CLASS_ATTR_LONG(this_class, "byteorder", 0, t_dmx_eurolite, byte_order);
+  CLASS_ATTR_ENUMINDEX(this_class, "byteorder", 0, "\"coarse first\" \"fine first\"");
+  CLASS_ATTR_LABEL(this_class, "byteorder", 0, "Byte order of set16 pairs");
+  CLASS_ATTR_MAX(this_class, "byteorder", 0, "1");
+  CLASS_ATTR_MIN(this_class, "byteorder", 0, "0");
+
+  CLASS_ATTR_LONG(this_class, "dither", 0, t_dmx_eurolite, ob);
+  CLASS_ATTR_STYLE_LABEL(this_class, "dither", 0, "onoff",
+                         "Dither values set with setf");
+  CLASS_ATTR_ACCESSORS(this_class, "dither", dmx_eurolite_dither_get,
+                       dmx_eurolite_dither_set);
+
+  CLASS_ATTR_LONG(this_class, "breaktime", 0, t_dmx_eurolite, ob);
+  CLASS_ATTR_LABEL(this_class, "breaktime", 0, "DMX break time (us)");
+  CLASS_ATTR_ACCESSORS(this_class, "breaktime", dmx_eurolite_breaktime_get,
+                       dmx_eurolite_breaktime_set);
+
+  CLASS_ATTR_LONG(this_class, "mabtime", 0, t_dmx_eurolite, ob);
+  CLASS_ATTR_LABEL(this_class, "mabtime", 0, "DMX mark after break time (us)");
+  CLASS_ATTR_ACCESSORS(this_class, "mabtime", dmx_eurolite_mabtime_get,
+                       dmx_eurolite_mabtime_set);
+
+  CLASS_ATTR_LONG(this_class, "outputrate", 0, t_dmx_eurolite, ob);
+  CLASS_ATTR_LABEL(this_class, "outputrate", 0, "Widget output rate (0 = max)");
+  CLASS_ATTR_MAX(this_class, "outputrate", 0, "40");
+  CLASS_ATTR_MIN(this_class, "outputrate", 0, "0");
+  CLASS_ATTR_ACCESSORS(this_class, "outputrate", dmx_eurolite_outputrate_get,
+                       dmx_eurolite_outputrate_set);
+
+  CLASS_ATTR_FLOAT(this_class, "framerate", ATTR_SET_OPAQUE, t_dmx_eurolite, ob);
+  CLASS_ATTR_LABEL(this_class, "framerate", 0, "Maximum frame rate (Hz)");
+  CLASS_ATTR_ACCESSORS(this_class, "framerate", dmx_eurolite_framerate_get,
+                       dmx_eurolite_ready_set);
+
+  CLASS_ATTR_LONG(this_class, "artnet", 0, t_dmx_eurolite, ob);
+  CLASS_ATTR_STYLE_LABEL(this_class, "artnet", 0, "onoff", "Art-Net input");
+  CLASS_ATTR_ACCESSORS(this_class, "artnet", dmx_eurolite_artnet_get,
+                       dmx_eurolite_artnet_set);
+
+  CLASS_ATTR_LONG(this_class, "artnetuniverse", 0, t_dmx_eurolite,
+                  artnet_universe);
+  CLASS_ATTR_LABEL(this_class, "artnetuniverse", 0,
+                   "Art-Net input port address");
+  CLASS_ATTR_MAX(this_class, "artnetuniverse", 0, "32767");
+  CLASS_ATTR_MIN(this_class, "artnetuniverse", 0, "0");
+  CLASS_ATTR_ACCESSORS(this_class, "artnetuniverse", NULL,
+                       dmx_eurolite_artnetuniverse_set);
+
+  CLASS_ATTR_LONG(this_class, "artnetout", 0, t_dmx_eurolite, ob);
+  CLASS_ATTR_STYLE_LABEL(this_class, "artnetout", 0, "onoff",
+                         "Art-Net output mirror");
+  CLASS_ATTR_ACCESSORS(this_class, "artnetout", dmx_eurolite_artnetout_get,
+                       dmx_eurolite_artnetout_set);
+
+  CLASS_ATTR_LONG(this_class, "artnetoutuniverse", 0, t_dmx_eurolite,
+                  artnet_out_universe);
+  CLASS_ATTR_LABEL(this_class, "artnetoutuniverse", 0,
+                   "Art-Net output port address");
+  CLASS_ATTR_MAX(this_class, "artnetoutuniverse", 0, "32767");
+  CLASS_ATTR_MIN(this_class, "artnetoutuniverse", 0, "0");
+  CLASS_ATTR_ACCESSORS(this_class, "artnetoutuniverse", NULL,
+                       dmx_eurolite_artnetoutuniverse_set);
+
+  CLASS_ATTR_SYM(this_class, "artnetouthost", 0, t_dmx_eurolite,
+                 artnet_out_host);
+  CLASS_ATTR_LABEL(this_class, "artnetouthost", 0,
+                   "Art-Net output destination address");
+  CLASS_ATTR_ACCESSORS(this_class, "artnetouthost", NULL,
+                       dmx_eurolite_artnetouthost_set);
+
+  CLASS_ATTR_LONG(this_class, "osc", 0, t_dmx_eurolite, ob);
+  CLASS_ATTR_STYLE_LABEL(this_class, "osc", 0, "onoff", "OSC input");
+  CLASS_ATTR_ACCESSORS(this_class, "osc", dmx_eurolite_osc_get,
+                       dmx_eurolite_osc_set);
+
+  CLASS_ATTR_LONG(this_class, "oscport", 0, t_dmx_eurolite, osc_port);
+  CLASS_ATTR_LABEL(this_class, "oscport", 0, "OSC input UDP port");
+  CLASS_ATTR_ACCESSORS(this_class, "oscport", NULL, dmx_eurolite_oscport_set);
+
+  CLASS_ATTR_SYM(this_class, "oscprefix", 0, t_dmx_eurolite, osc_prefix);
+  CLASS_ATTR_LABEL(this_class, "oscprefix", 0, "OSC address prefix");
+  CLASS_ATTR_ACCESSORS(this_class, "oscprefix", NULL,
+                       dmx_eurolite_oscprefix_set);
+
+  CLASS_ATTR_LONG(this_class, "shm", 0, t_dmx_eurolite, ob);
+  CLASS_ATTR_STYLE_LABEL(this_class, "shm", 0, "onoff",
+                         "Shared memory frame interface");
+  CLASS_ATTR_ACCESSORS(this_class, "shm", dmx_eurolite_shm_get,
+                       dmx_eurolite_shm_set);
+
+  CLASS_ATTR_SYM(this_class, "scenefile", 0, t_dmx_eurolite, scene_file);
+  CLASS_ATTR_LABEL(this_class, "scenefile", 0, "Scene library file");
+  CLASS_ATTR_ACCESSORS(this_class, "scenefile", NULL, dmx_eurolite_scenefile_set);
+
+  CLASS_ATTR_SYM(this_class, "shmname", 0, t_dmx_eurolite, shm_name);
+  CLASS_ATTR_LABEL(this_class, "shmname", 0, "Shared memory segment name");
+  CLASS_ATTR_ACCESSORS(this_class, "shmname", NULL, dmx_eurolite_shmname_set);
+
+  CLASS_ATTR_LONG(this_class, "sacn", 0, t_dmx_eurolite, ob);
+  CLASS_ATTR_STYLE_LABEL(this_class, "sacn", 0, "onoff", "sACN (E1.31) input");
+  CLASS_ATTR_ACCESSORS(this_class, "sacn", dmx_eurolite_sacn_get,
+                       dmx_eurolite_sacn_set);
+
+  CLASS_ATTR_LONG(this_class, "sacnuniverse", 0, t_dmx_eurolite, sacn_universe);
+  CLASS_ATTR_LABEL(this_class, "sacnuniverse", 0, "sACN input universe");
+  CLASS_ATTR_MAX(this_class, "sacnuniverse", 0, "63999");
+  CLASS_ATTR_MIN(this_class, "sacnuniverse", 0, "1");
+  CLASS_ATTR_ACCESSORS(this_class, "sacnuniverse", NULL,
+                       dmx_eurolite_sacnuniverse_set);
 
   // readonly attribute with custom no-op setter (querying the state of dmx
   // object)
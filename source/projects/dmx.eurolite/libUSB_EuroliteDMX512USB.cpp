@@ -1,10 +1,25 @@
 #include "libUSB_EuroliteDMX512USB.hpp"
 
+#include <chrono>
+
 #define print_debug(xxx)
 
+static uint64_t steady_time_us()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
 LibUSB_EuroliteDMX512USB::LibUSB_EuroliteDMX512USB()
-    : data(new unsigned char[data_size]), timeout(150u)
+    : data(new unsigned char[data_size]), timeout(150u),
+      frames_sent(0), transfer_errors(0),
+      tx_data(new unsigned char[data_size]),
+      input_ring_head(0), input_ring_tail(0), input_latest(-1),
+      input_changes_head(0), input_changes_tail(0)
 {
+    std::memset(input_universe, 0, sizeof(input_universe));
+    update_frame_period(); // pace with the default timing
     initialize_data();
     initialize_libusb();
 }
@@ -13,11 +28,16 @@ LibUSB_EuroliteDMX512USB::~LibUSB_EuroliteDMX512USB()
 {
     if (ready)
         close_device();
+    if (in_xfr && !input_transfer_pending)
+        libusb_free_transfer(in_xfr);
+    if (rdm_xfr && !rdm_transfer_pending)
+        libusb_free_transfer(rdm_xfr);
 
     if (context != NULL)
         libusb_exit(context);
 
     delete[] data;
+    delete[] tx_data;
 }
 
 void LibUSB_EuroliteDMX512USB::initialize_libusb()
@@ -38,6 +58,50 @@ void LibUSB_EuroliteDMX512USB::initialize_data()
     data[4] = 0;                   // start code (Null Start Code)
     std::memset(data + 5, 0, 512); // zero whole DMX univ.
     data[data_size - 1] = 0xe7;    // end of message
+    std::memset(fine_data, 0, sizeof(fine_data));
+    std::memset(fine_active, 0, sizeof(fine_active));
+    std::memset(dither_error, 0, sizeof(dither_error));
+    std::memcpy(tx_data, data, data_size);
+}
+
+void LibUSB_EuroliteDMX512USB::build_frame()
+{
+    {
+        std::lock_guard<std::mutex> lock(layers_mutex);
+        for (size_t i = 0; i < frame_listeners.size(); i++)
+            frame_listeners[i]->frame_will_build();
+    }
+    {
+        std::lock_guard<std::mutex> lock(data_mutex);
+        std::memcpy(tx_data + 5, data + 5, 512);
+        if (dither)
+            dither_fine_channels(tx_data + 5);
+    }
+
+    // HTP merge of the latest received frame
+    const int latest = input_latest.load(std::memory_order_acquire);
+    if (input_merge && input_on_change)
+    {
+        unsigned char *out = tx_data + 5;
+        for (int i = 0; i < 512; i++)
+            out[i] = std::max(out[i], input_universe[i]);
+    }
+    else if (input_merge && latest >= 0)
+    {
+        const DMXInputFrame &f = input_ring[latest];
+        if (f.start_code == 0)
+        {
+            unsigned char *out = tx_data + 5;
+            for (int i = 0; i < f.size; i++)
+                out[i] = std::max(out[i], f.slots[i]);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(layers_mutex);
+    for (size_t i = 0; i < layers.size(); i++)
+        layers[i]->merge_into(tx_data + 5);
+    for (size_t i = 0; i < frame_listeners.size(); i++)
+        frame_listeners[i]->frame_will_send(tx_data + 5, 512);
 }
 
 // Report state
@@ -46,7 +110,32 @@ bool LibUSB_EuroliteDMX512USB::is_ready()
     return ready;
 }
 
-bool LibUSB_EuroliteDMX512USB::open_device()
+libusb_device_handle *LibUSB_EuroliteDMX512USB::open_device_by_index(int index)
+{
+    libusb_device **list;
+    libusb_device_handle *handle = NULL;
+    const ssize_t count = libusb_get_device_list(context, &list);
+    if (count < 0)
+        return NULL;
+    for (ssize_t i = 0; i < count; i++)
+    {
+        struct libusb_device_descriptor desc;
+        if (libusb_get_device_descriptor(list[i], &desc) != LIBUSB_SUCCESS)
+            continue;
+        if (desc.idVendor != 0x4d8 || desc.idProduct != 0xfa63)
+            continue;
+        if (index-- == 0)
+        {
+            if (libusb_open(list[i], &handle) != LIBUSB_SUCCESS)
+                handle = NULL;
+            break;
+        }
+    }
+    libusb_free_device_list(list, 1);
+    return handle;
+}
+
+bool LibUSB_EuroliteDMX512USB::open_device(int index)
 {
     print_debug("Opening device");
     if (context == NULL)
@@ -54,7 +143,9 @@ bool LibUSB_EuroliteDMX512USB::open_device()
     if (context != NULL)
     {
         if (euro_handle == NULL)
-            euro_handle = libusb_open_device_with_vid_pid(context, 0x4d8, 0xfa63);
+            euro_handle = (index == 0)
+                              ? libusb_open_device_with_vid_pid(context, 0x4d8, 0xfa63)
+                              : open_device_by_index(index);
         if (euro_handle != NULL)
         {
             print_debug("Device opened.");
@@ -65,6 +156,13 @@ bool LibUSB_EuroliteDMX512USB::open_device()
                 // async - on
                 enable_async_transfer(true);
                 ready = true;
+                if (params_set)
+                    set_widget_parameters(get_break_time_us(), get_mab_time_us(), output_rate);
+                else
+                    update_frame_period();
+                if (input_enabled)
+                    send_receive_mode();
+                input_transfer_submit();
                 return ready;
             }
         }
@@ -78,15 +176,36 @@ void LibUSB_EuroliteDMX512USB::close_device()
     print_debug("Closing device.");
     if (euro_handle != NULL)
     {
-        int ret = libusb_release_interface(euro_handle, 1);
-        if (ret >= 0)
+        if (input_transfer_pending)
+            libusb_cancel_transfer(in_xfr);
+        if (rdm_transfer_pending)
+            libusb_cancel_transfer(rdm_xfr);
+        if (input_transfer_pending || rdm_transfer_pending)
         {
-            // async - off
-            enable_async_transfer(false);
-            libusb_close(euro_handle);
-            euro_handle = NULL;
-            ready = false;
+            // give libusb a chance to deliver the cancellation
+            struct timeval tv = {0, 100000};
+            libusb_handle_events_timeout_completed(context, &tv, NULL);
         }
+        // fails with LIBUSB_ERROR_NO_DEVICE after an unplug, the handle
+        // is closed anyway so open_device() can find the widget again
+        libusb_release_interface(euro_handle, 1);
+        // async - off
+        enable_async_transfer(false);
+        libusb_close(euro_handle);
+        euro_handle = NULL;
+    }
+    ready = false;
+    // the callback frees a cancelled transfer once delivered; one that
+    // isn't in flight (or never got its callback) is ours to free
+    if (in_xfr && !input_transfer_pending)
+    {
+        libusb_free_transfer(in_xfr);
+        in_xfr = NULL;
+    }
+    if (rdm_xfr && !rdm_transfer_pending)
+    {
+        libusb_free_transfer(rdm_xfr);
+        rdm_xfr = NULL;
     }
 }
 
@@ -94,6 +213,7 @@ void LibUSB_EuroliteDMX512USB::clear_all_channels()
 {
     data_mutex.lock();
     std::memset(data + 5, 0, 512);
+    std::memset(fine_active, 0, sizeof(fine_active));
     data_mutex.unlock();
 }
 
@@ -144,24 +264,104 @@ void LibUSB_EuroliteDMX512USB::set_channel_memcpy_from(int from, int c, unsigned
     std::memcpy(data + 5 + from, v, c);
 }
 
+void LibUSB_EuroliteDMX512USB::get_channels(unsigned char *dest)
+{
+    std::lock_guard<std::mutex> lock(data_mutex);
+    std::memcpy(dest, data + 5, 512);
+}
+
+void LibUSB_EuroliteDMX512USB::set_channel16_from(int from, int c, const uint16_t *v, bool lsb_first)
+{
+    const int hi = lsb_first ? 1 : 0;
+    // whole pairs only, a half written value would be worse than none
+    write_channels(from, 2 * c, [v, hi](unsigned char *dest, int count) {
+        for (int i = 0; i < count / 2; i++)
+        {
+            dest[2 * i + hi] = (unsigned char)(v[i] >> 8);
+            dest[2 * i + 1 - hi] = (unsigned char)(v[i] & 0xff);
+        }
+    });
+}
+
+void LibUSB_EuroliteDMX512USB::set_channel_float_from(int from, int c, const float *v)
+{
+    if (from < 0 || from > 511 || c <= 0) // safety check
+        return;
+    if (c + from > 512) // safety check
+        c = 512 - from;
+    // quantise outside of the lock, plain loop so it is vectorised
+    uint16_t fine[512];
+    unsigned char rounded[512];
+    for (int i = 0; i < c; i++)
+    {
+        const float f = v[i] > 0.f ? std::min(v[i], 1.f) : 0.f; // NaN too
+        fine[i] = (uint16_t)(f * (255.f * 256.f) + 0.5f);
+        rounded[i] = (unsigned char)((fine[i] + 128) >> 8);
+    }
+    std::lock_guard<std::mutex> lock(data_mutex);
+    std::memcpy(data + 5 + from, rounded, c);
+    std::memcpy(fine_data + from, fine, c * sizeof(uint16_t));
+    std::memset(fine_active + from, 1, c);
+}
+
+void LibUSB_EuroliteDMX512USB::set_dither(bool will_be_dithered)
+{
+    dither = will_be_dithered;
+}
+
+bool LibUSB_EuroliteDMX512USB::get_dither()
+{
+    return dither;
+}
+
+void LibUSB_EuroliteDMX512USB::dither_fine_channels(unsigned char *out)
+{
+    for (int i = 0; i < 512; i++)
+    {
+        if (!fine_active[i])
+            continue;
+        const uint16_t fine = fine_data[i];
+        // channel rewritten by other means since
+        if (data[5 + i] != ((fine + 128) >> 8))
+        {
+            fine_active[i] = false;
+            continue;
+        }
+        // first order error feedback: the fraction adds up over frames
+        // and carries into the next level, averaging to the exact value
+        const unsigned int sum = dither_error[i] + (fine & 0xff);
+        const unsigned int carry = sum >> 8;
+        dither_error[i] = (uint16_t)(sum & 0xff);
+        out[i] = (unsigned char)((fine >> 8) + carry);
+    }
+}
+
 // ---- SYNC TRANSFER ----
 
 void LibUSB_EuroliteDMX512USB::sync_transfer_data()
 {
     if (!ready)
         return;
+    // paced like service_async_transfer(), an early frame is skipped
+    const uint64_t now = steady_time_us();
+    if (frame_period_us && now - last_frame_us + frame_period_us / 8 < frame_period_us)
+        return;
+    last_frame_us = now;
     print_debug("sync transfer stared");
-    data_mutex.lock();
+    build_frame();
     // let's assume the interface has a proper EP (0x02), interface #1
     sync_transfer_status = libusb_bulk_transfer(
         euro_handle,                 // dev handle
         (0x2 | LIBUSB_ENDPOINT_OUT), // EP
-        data,                        // data
+        tx_data,                     // data
         data_size,                   // size
         NULL,                        // & bytes sent
         timeout                      // timeout (ms)
     );
-    data_mutex.unlock();
+    if (sync_transfer_status == LIBUSB_SUCCESS)
+        notify_frame_sent();
+    else
+        transfer_errors++;
     if (sync_transfer_status == LIBUSB_ERROR_NO_DEVICE)
         close_device();
     print_debug("sync transfer completed");
@@ -175,25 +375,29 @@ void LibUSB_EuroliteDMX512USB::async_transfer_fill_and_submit()
     if (async_transfer_pending)
         return;
     print_debug("async transfer fill&submit starts");
-    data_mutex.lock();
+    build_frame();
     libusb_fill_bulk_transfer(
         xfr,
         euro_handle,                 // dev handle
         (0x2 | LIBUSB_ENDPOINT_OUT), // EP (OUT 0x2, interface #1)
-        data,                        // data
+        tx_data,                     // data
         data_size,                   // size
         cb_async_xfr_complete,       // callback
         this,                        // user_data = this instance
         timeout                      // timeout (ms)
     );
     async_submit_status = libusb_submit_transfer(xfr);
-    data_mutex.unlock();
     print_debug("async transfer fill&submit finished");
 
+    if (async_submit_status != LIBUSB_SUCCESS)
+        transfer_errors++;
     if (async_submit_status == LIBUSB_ERROR_NO_DEVICE)
         close_device();
     else if (async_submit_status == LIBUSB_SUCCESS)
+    {
         async_transfer_pending = true;
+        notify_frame_sent(); // transfer is already on its way
+    }
 }
 
 void LibUSB_EuroliteDMX512USB::async_transfer_cancel()
@@ -204,8 +408,16 @@ void LibUSB_EuroliteDMX512USB::async_transfer_cancel()
 
 void LibUSB_EuroliteDMX512USB::async_transfer_tick()
 {
-    //libusb_handle_events_timeout_completed(context, &zero_tv, NULL);
-    async_event_handling_status = (libusb_error)libusb_handle_events_completed(context, NULL);
+    // the IN transfer is always pending or the host polls, don't block
+    if (nonblocking_events || input_wanted())
+        async_event_handling_status = (libusb_error)libusb_handle_events_timeout_completed(context, &zero_tv, NULL);
+    else
+        async_event_handling_status = (libusb_error)libusb_handle_events_completed(context, NULL);
+}
+
+void LibUSB_EuroliteDMX512USB::set_nonblocking_events(bool nonblocking)
+{
+    nonblocking_events = nonblocking;
 }
 
 void LibUSB_EuroliteDMX512USB::service_async_transfer()
@@ -214,7 +426,18 @@ void LibUSB_EuroliteDMX512USB::service_async_transfer()
     if (!ready)
         return;
     if (async_transfer_enabled && !async_transfer_wait_for_disable)
+    {
+        // don't outrun the widget: a frame sent before the previous one
+        // left the wire would only be queued (1/8 period of slack for jitter)
+        const uint64_t now = steady_time_us();
+        if (frame_period_us && now - last_frame_us + frame_period_us / 8 < frame_period_us)
+            return;
         async_transfer_fill_and_submit();
+        if (async_transfer_pending)
+            last_frame_us = now;
+        if (rdm)
+            rdm->tick(now);
+    }
     else
     {
         if (async_transfer_pending)
@@ -258,6 +481,484 @@ void LibUSB_EuroliteDMX512USB::enable_async_transfer(bool will_be_enabled)
     }
 }
 
+// ---- DMX INPUT ----
+
+void LibUSB_EuroliteDMX512USB::enable_input(bool will_be_enabled)
+{
+    if (will_be_enabled && !input_enabled)
+    {
+        input_enabled = true;
+        rx_state = RX_WAIT_START;
+        if (ready)
+        {
+            send_receive_mode();
+            input_transfer_submit();
+        }
+    }
+    else if (!will_be_enabled && input_enabled)
+    {
+        input_enabled = false;
+        if (rdm) // keep reading for RDM responses
+            return;
+        if (input_transfer_pending)
+            libusb_cancel_transfer(in_xfr); // freed in the callback
+        else if (in_xfr)
+        {
+            libusb_free_transfer(in_xfr);
+            in_xfr = NULL;
+        }
+    }
+}
+
+void LibUSB_EuroliteDMX512USB::set_input_report(bool will_be_reported)
+{
+    input_report = will_be_reported;
+    if (!input_report) // drop queued frames, the parser won't wait for them
+    {
+        input_ring_tail.store(input_ring_head.load());
+        input_changes_tail.store(input_changes_head.load());
+    }
+}
+
+void LibUSB_EuroliteDMX512USB::set_input_on_change(bool on_change)
+{
+    if (on_change == input_on_change)
+        return;
+    input_on_change = on_change;
+    if (ready && input_enabled)
+        send_receive_mode();
+}
+
+void LibUSB_EuroliteDMX512USB::send_receive_mode()
+{
+    // 0 - send always (label 5), 1 - send on change only (label 9)
+    unsigned char mode = input_on_change ? 1 : 0;
+    send_widget_message(0x08, &mode, 1);
+}
+
+void LibUSB_EuroliteDMX512USB::set_input_merge(bool will_be_merged)
+{
+    input_merge = will_be_merged;
+}
+
+void LibUSB_EuroliteDMX512USB::service_input()
+{
+    async_transfer_tick();
+    input_transfer_submit();
+    if (rdm && ready)
+        rdm->tick(steady_time_us());
+}
+
+const DMXInputFrame *LibUSB_EuroliteDMX512USB::input_frame_peek()
+{
+    const unsigned int tail = input_ring_tail.load(std::memory_order_relaxed);
+    if (tail == input_ring_head.load(std::memory_order_acquire))
+        return NULL;
+    return &input_ring[tail % input_ring_size];
+}
+
+void LibUSB_EuroliteDMX512USB::input_frame_release()
+{
+    const unsigned int tail = input_ring_tail.load(std::memory_order_relaxed);
+    if (tail != input_ring_head.load(std::memory_order_acquire))
+        input_ring_tail.store(tail + 1, std::memory_order_release);
+}
+
+int LibUSB_EuroliteDMX512USB::input_changes_read(DMXInputChange *dest, int max)
+{
+    unsigned int tail = input_changes_tail.load(std::memory_order_relaxed);
+    const unsigned int head = input_changes_head.load(std::memory_order_acquire);
+    int n = 0;
+    for (; tail != head && n < max; tail++, n++)
+        dest[n] = input_changes[tail % input_changes_size];
+    input_changes_tail.store(tail, std::memory_order_release);
+    return n;
+}
+
+void LibUSB_EuroliteDMX512USB::input_transfer_submit()
+{
+    if (!ready || !input_wanted() || input_transfer_pending)
+        return;
+    if (!in_xfr)
+        in_xfr = libusb_alloc_transfer(0);
+    if (!in_xfr)
+        return;
+    libusb_fill_bulk_transfer(
+        in_xfr,
+        euro_handle,                 // dev handle
+        (0x1 | LIBUSB_ENDPOINT_IN),  // EP (IN 0x81, interface #1)
+        in_buffer,                   // data
+        in_buffer_size,              // size
+        cb_input_xfr_complete,       // callback
+        this,                        // user_data = this instance
+        0                            // no timeout, widget sends when it has data
+    );
+    int ret = libusb_submit_transfer(in_xfr);
+    if (ret == LIBUSB_SUCCESS)
+        input_transfer_pending = true;
+    else if (ret == LIBUSB_ERROR_NO_DEVICE)
+        close_device();
+}
+
+void LibUSB_EuroliteDMX512USB::parse_widget_bytes(const unsigned char *bytes, int length)
+{
+    for (int i = 0; i < length; i++)
+    {
+        const unsigned char b = bytes[i];
+        switch (rx_state)
+        {
+        case RX_WAIT_START:
+            if (b == 0x7e)
+                rx_state = RX_LABEL;
+            break;
+        case RX_LABEL:
+            rx_label = b;
+            rx_state = RX_LENGTH_LSB;
+            break;
+        case RX_LENGTH_LSB:
+            rx_length = b;
+            rx_state = RX_LENGTH_MSB;
+            break;
+        case RX_LENGTH_MSB:
+            rx_length |= (unsigned int)b << 8;
+            rx_count = 0;
+            if (rx_length > rx_payload_size) // not a valid packet, resync
+                rx_state = RX_WAIT_START;
+            else
+                rx_state = rx_length ? RX_PAYLOAD : RX_END;
+            break;
+        case RX_PAYLOAD:
+            if (rx_label == 0x05 && rx_count == 0)
+            {
+                // received DMX goes straight to the next ring slot,
+                // unless the consumer hasn't made room for it
+                const unsigned int head = input_ring_head.load(std::memory_order_relaxed);
+                rx_to_ring = head - input_ring_tail.load(std::memory_order_acquire) < input_ring_size;
+            }
+            if (rx_label == 0x05 && rx_to_ring)
+            {
+                DMXInputFrame &f = input_ring[input_ring_head.load(std::memory_order_relaxed) % input_ring_size];
+                if (rx_count == 0)
+                    f.status = b;
+                else if (rx_count == 1)
+                    f.start_code = b;
+                else if (rx_count - 2 < 512)
+                    f.slots[rx_count - 2] = b;
+            }
+            else
+                rx_payload[rx_count] = b;
+            if (++rx_count == rx_length)
+                rx_state = RX_END;
+            break;
+        case RX_END:
+            if (b == 0xe7)
+                handle_widget_packet();
+            rx_state = RX_WAIT_START;
+            break;
+        }
+    }
+}
+
+void LibUSB_EuroliteDMX512USB::handle_widget_packet()
+{
+    if (rx_label == 0x0c) // RDM receive timeout
+    {
+        if (rdm)
+            rdm->handle_timeout();
+        return;
+    }
+    if (rx_label == 0x03 && rx_length >= 5)
+    {
+        firmware_version = rx_payload[0] | (rx_payload[1] << 8);
+        break_time = rx_payload[2];
+        mab_time = rx_payload[3];
+        output_rate = rx_payload[4];
+        params_valid = true;
+        update_frame_period();
+        return;
+    }
+    if (rx_label == 0x09)
+    {
+        handle_change_packet();
+        return;
+    }
+    if (rx_label == 0x05 && rx_length >= 2)
+    {
+        const unsigned int head = input_ring_head.load(std::memory_order_relaxed);
+        DMXInputFrame &f = input_ring[head % input_ring_size];
+        const unsigned char start_code = rx_to_ring ? f.start_code : rx_payload[1];
+        const unsigned char *slots = rx_to_ring ? f.slots : rx_payload + 2;
+        const int size = (int)std::min(rx_length - 2, 512u);
+        // RDM response (0xCC) or discovery response (0xFE/0xAA preamble),
+        // routed even while the ring is full
+        if (rdm && (start_code == 0xcc || start_code == 0xfe || start_code == 0xaa))
+        {
+            unsigned char packet[257];
+            const int length = std::min(size + 1, 257);
+            packet[0] = start_code;
+            std::memcpy(packet + 1, slots, length - 1);
+            rdm->handle_response(packet, length);
+            return;
+        }
+        if (!input_enabled)
+            return;
+        if (!rx_to_ring)
+        {
+            input_overruns++;
+            return;
+        }
+        f.timestamp_us = steady_time_us();
+        f.size = (unsigned short)size;
+        input_latest.store(head % input_ring_size, std::memory_order_release);
+        input_ring_head.store(head + 1, std::memory_order_release);
+        if (!input_report)
+            input_ring_tail.store(head + 1, std::memory_order_release);
+    }
+}
+
+void LibUSB_EuroliteDMX512USB::handle_change_packet()
+{
+    // payload: start changed byte (in units of 8 slots), 5 bytes of
+    // changed bit array (40 slots), then values of changed slots only.
+    // Slot 0 is the start code.
+    if (rx_length < 6)
+        return;
+    const unsigned int first = rx_payload[0] * 8;
+    unsigned int k = 6;
+    unsigned int head = input_changes_head.load(std::memory_order_relaxed);
+    for (unsigned int bit = 0; bit < 40 && k < rx_length; bit++)
+    {
+        if (!(rx_payload[1 + bit / 8] & (1 << (bit % 8))))
+            continue;
+        const unsigned char value = rx_payload[k++];
+        const unsigned int slot = first + bit;
+        if (slot == 0 || slot > 512)
+            continue;
+        input_universe[slot - 1] = value;
+        if (!input_report)
+            continue;
+        if (head - input_changes_tail.load(std::memory_order_acquire) >= input_changes_size)
+        {
+            input_overruns++;
+            continue;
+        }
+        DMXInputChange &c = input_changes[head % input_changes_size];
+        c.channel = (unsigned short)(slot - 1);
+        c.value = value;
+        head++;
+    }
+    input_changes_head.store(head, std::memory_order_release);
+}
+
+int LibUSB_EuroliteDMX512USB::send_widget_message(unsigned char label, const unsigned char *payload, int length)
+{
+    if (!ready)
+        return LIBUSB_ERROR_NO_DEVICE;
+    if (length < 0 || length > (int)rx_payload_size)
+        return LIBUSB_ERROR_INVALID_PARAM;
+    unsigned char msg[rx_payload_size + 5];
+    return libusb_bulk_transfer(
+        euro_handle,                 // dev handle
+        (0x2 | LIBUSB_ENDPOINT_OUT), // EP
+        msg,                         // data
+        build_widget_message(msg, label, payload, length), // size
+        NULL,                        // & bytes sent
+        timeout                      // timeout (ms)
+    );
+}
+
+int LibUSB_EuroliteDMX512USB::build_widget_message(unsigned char *msg, unsigned char label,
+                                                   const unsigned char *payload, int length)
+{
+    msg[0] = 0x7e;                // start of message
+    msg[1] = label;               // label
+    msg[2] = length & 0xff;       // data length LSB
+    msg[3] = (length >> 8) & 0xff; // data length MSB
+    if (length)
+        std::memcpy(msg + 4, payload, length);
+    msg[4 + length] = 0xe7;       // end of message
+    return length + 5;
+}
+
+// ---- LAYERS ----
+
+void LibUSB_EuroliteDMX512USB::add_layer(DMXLayer *layer)
+{
+    std::lock_guard<std::mutex> lock(layers_mutex);
+    if (std::find(layers.begin(), layers.end(), layer) == layers.end())
+        layers.push_back(layer);
+}
+
+void LibUSB_EuroliteDMX512USB::remove_layer(DMXLayer *layer)
+{
+    std::lock_guard<std::mutex> lock(layers_mutex);
+    layers.erase(std::remove(layers.begin(), layers.end(), layer), layers.end());
+}
+
+void LibUSB_EuroliteDMX512USB::add_frame_listener(DMXFrameListener *listener)
+{
+    std::lock_guard<std::mutex> lock(layers_mutex);
+    if (std::find(frame_listeners.begin(), frame_listeners.end(), listener) == frame_listeners.end())
+        frame_listeners.push_back(listener);
+}
+
+void LibUSB_EuroliteDMX512USB::remove_frame_listener(DMXFrameListener *listener)
+{
+    std::lock_guard<std::mutex> lock(layers_mutex);
+    frame_listeners.erase(std::remove(frame_listeners.begin(), frame_listeners.end(), listener),
+                          frame_listeners.end());
+}
+
+void LibUSB_EuroliteDMX512USB::notify_frame_sent()
+{
+    frames_sent++;
+    std::lock_guard<std::mutex> lock(layers_mutex);
+    for (size_t i = 0; i < frame_listeners.size(); i++)
+        frame_listeners[i]->frame_sent(tx_data + 5, 512);
+}
+
+// ---- RDM ----
+
+void LibUSB_EuroliteDMX512USB::set_rdm_controller(RDMController *controller)
+{
+    rdm = controller;
+    if (rdm && !input_transfer_pending)
+    {
+        rx_state = RX_WAIT_START;
+        input_transfer_submit();
+    }
+    else if (!input_wanted() && input_transfer_pending)
+        libusb_cancel_transfer(in_xfr); // freed in the callback
+}
+
+bool LibUSB_EuroliteDMX512USB::rdm_send(const unsigned char *packet, int length, bool discovery)
+{
+    if (!ready || rdm_transfer_pending || length < 0 || length > 257)
+        return false;
+    if (!rdm_xfr)
+        rdm_xfr = libusb_alloc_transfer(0);
+    if (!rdm_xfr)
+        return false;
+    libusb_fill_bulk_transfer(
+        rdm_xfr,
+        euro_handle,                 // dev handle
+        (0x2 | LIBUSB_ENDPOINT_OUT), // EP (OUT 0x2, interface #1)
+        rdm_msg,                     // data
+        build_widget_message(rdm_msg, discovery ? 0x0b : 0x07, packet, length), // size
+        cb_rdm_xfr_complete,         // callback
+        this,                        // user_data = this instance
+        timeout                      // timeout (ms)
+    );
+    const int ret = libusb_submit_transfer(rdm_xfr);
+    if (ret == LIBUSB_SUCCESS)
+        rdm_transfer_pending = true;
+    else
+    {
+        transfer_errors++;
+        if (ret == LIBUSB_ERROR_NO_DEVICE)
+            close_device();
+    }
+    return ret == LIBUSB_SUCCESS;
+}
+
+bool LibUSB_EuroliteDMX512USB::rdm_ready()
+{
+    return !rdm_transfer_pending;
+}
+
+bool LibUSB_EuroliteDMX512USB::input_wanted()
+{
+    return input_enabled || rdm != NULL;
+}
+
+// ---- WIDGET PARAMETERS ----
+
+bool LibUSB_EuroliteDMX512USB::request_widget_parameters()
+{
+    const unsigned char user_size[2] = {0, 0}; // no user configuration
+    params_valid = false;
+    if (send_widget_message(0x03, user_size, 2) != LIBUSB_SUCCESS)
+        return false;
+
+    const uint64_t deadline = steady_time_us() + timeout * 1000ull;
+    while (!params_valid && steady_time_us() < deadline)
+    {
+        if (input_wanted())
+        {
+            // reply comes with the pending IN transfer
+            struct timeval tv = {0, 10000};
+            libusb_handle_events_timeout_completed(context, &tv, NULL);
+        }
+        else
+        {
+            int received = 0;
+            int ret = libusb_bulk_transfer(
+                euro_handle,                 // dev handle
+                (0x1 | LIBUSB_ENDPOINT_IN),  // EP
+                in_buffer,                   // data
+                in_buffer_size,              // size
+                &received,                   // & bytes received
+                timeout                      // timeout (ms)
+            );
+            if (ret != LIBUSB_SUCCESS && ret != LIBUSB_ERROR_TIMEOUT)
+                return false;
+            parse_widget_bytes(in_buffer, received);
+        }
+    }
+    return params_valid;
+}
+
+bool LibUSB_EuroliteDMX512USB::set_widget_parameters(int break_us, int mab_us, int rate)
+{
+    // widget time unit is 10.67 us
+    break_time = (unsigned char)std::max(9, std::min(127, (int)(break_us / 10.67 + 0.5)));
+    mab_time = (unsigned char)std::max(1, std::min(127, (int)(mab_us / 10.67 + 0.5)));
+    output_rate = (unsigned char)std::max(0, std::min(40, rate));
+    params_set = true;
+    update_frame_period();
+
+    const unsigned char payload[5] = {
+        0, 0, // no user configuration
+        break_time,
+        mab_time,
+        output_rate};
+    return send_widget_message(0x04, payload, 5) == LIBUSB_SUCCESS;
+}
+
+void LibUSB_EuroliteDMX512USB::update_frame_period()
+{
+    // break + MAB + start code and 512 slots (44 us each) on the wire
+    const unsigned int wire_us =
+        (unsigned int)((break_time + mab_time) * 10.67) + 513 * 44;
+    const unsigned int rate_us = output_rate ? 1000000u / output_rate : 0;
+    frame_period_us = std::max(wire_us, rate_us);
+}
+
+int LibUSB_EuroliteDMX512USB::get_break_time_us()
+{
+    return (int)(break_time * 10.67 + 0.5);
+}
+
+int LibUSB_EuroliteDMX512USB::get_mab_time_us()
+{
+    return (int)(mab_time * 10.67 + 0.5);
+}
+
+int LibUSB_EuroliteDMX512USB::get_output_rate()
+{
+    return output_rate;
+}
+
+int LibUSB_EuroliteDMX512USB::get_firmware_version()
+{
+    return firmware_version;
+}
+
+unsigned int LibUSB_EuroliteDMX512USB::get_frame_period_us()
+{
+    return frame_period_us;
+}
+
 // ---- ACCESS THE STATE ----
 
 bool LibUSB_EuroliteDMX512USB::get_async_transfer_enabled()
@@ -265,6 +966,31 @@ bool LibUSB_EuroliteDMX512USB::get_async_transfer_enabled()
     return async_transfer_enabled;
 }
 
+bool LibUSB_EuroliteDMX512USB::get_input_enabled()
+{
+    return input_enabled;
+}
+
+bool LibUSB_EuroliteDMX512USB::get_input_report()
+{
+    return input_report;
+}
+
+bool LibUSB_EuroliteDMX512USB::get_input_merge()
+{
+    return input_merge;
+}
+
+bool LibUSB_EuroliteDMX512USB::get_input_on_change()
+{
+    return input_on_change;
+}
+
+unsigned int LibUSB_EuroliteDMX512USB::get_input_overruns()
+{
+    return input_overruns;
+}
+
 void LibUSB_EuroliteDMX512USB::set_timeout(int atimeout)
 {
     timeout = (unsigned int)atimeout;
@@ -275,6 +1001,16 @@ unsigned int LibUSB_EuroliteDMX512USB::get_timeout()
     return timeout;
 }
 
+unsigned long LibUSB_EuroliteDMX512USB::get_frames_sent()
+{
+    return frames_sent;
+}
+
+unsigned long LibUSB_EuroliteDMX512USB::get_transfer_errors()
+{
+    return transfer_errors;
+}
+
 std::string LibUSB_EuroliteDMX512USB::get_channels_as_string()
 {
     std::ostringstream oss;
@@ -305,11 +1041,18 @@ const char *LibUSB_EuroliteDMX512USB::get_async_event_status_name()
     return libusb_error_name(async_event_handling_status);
 }
 
+const char *LibUSB_EuroliteDMX512USB::get_input_transfer_status_name()
+{
+    return libusb_error_name(input_transfer_status);
+}
+
 void LibUSB_EuroliteDMX512USB::cb_async_xfr_complete(struct libusb_transfer *x)
 {
     LibUSB_EuroliteDMX512USB *me = (LibUSB_EuroliteDMX512USB *)x->user_data;
     me->async_transfer_pending = false;
     me->async_transfer_status = x->status;
+    if (x->status != LIBUSB_TRANSFER_COMPLETED && x->status != LIBUSB_TRANSFER_CANCELLED)
+        me->transfer_errors++;
     if (x->status == LIBUSB_TRANSFER_NO_DEVICE)
         me->close_device();
     else if (x->status == LIBUSB_TRANSFER_CANCELLED && me->async_transfer_wait_for_disable)
@@ -318,3 +1061,39 @@ void LibUSB_EuroliteDMX512USB::cb_async_xfr_complete(struct libusb_transfer *x)
         me->enable_async_transfer(false);
     }
 }
+
+void LibUSB_EuroliteDMX512USB::cb_rdm_xfr_complete(struct libusb_transfer *x)
+{
+    LibUSB_EuroliteDMX512USB *me = (LibUSB_EuroliteDMX512USB *)x->user_data;
+    me->rdm_transfer_pending = false;
+    // a lost packet shows up as a response timeout in the controller
+    if (x->status != LIBUSB_TRANSFER_COMPLETED && x->status != LIBUSB_TRANSFER_CANCELLED)
+        me->transfer_errors++;
+    if (x->status == LIBUSB_TRANSFER_NO_DEVICE)
+        me->close_device(); // frees the transfer
+}
+
+void LibUSB_EuroliteDMX512USB::cb_input_xfr_complete(struct libusb_transfer *x)
+{
+    LibUSB_EuroliteDMX512USB *me = (LibUSB_EuroliteDMX512USB *)x->user_data;
+    me->input_transfer_pending = false;
+    me->input_transfer_status = x->status;
+    if (x->status == LIBUSB_TRANSFER_COMPLETED)
+        me->parse_widget_bytes(x->buffer, x->actual_length);
+
+    if (x->status == LIBUSB_TRANSFER_NO_DEVICE)
+    {
+        me->close_device(); // frees the transfer
+        return;
+    }
+    if (me->input_wanted() && me->ready && x->status == LIBUSB_TRANSFER_COMPLETED)
+    {
+        me->input_transfer_submit(); // keep reading (errors are retried in service_input)
+        return;
+    }
+    if (!me->input_wanted())
+    {
+        libusb_free_transfer(x);
+        me->in_xfr = NULL;
+    }
+}
\ No newline at end of file
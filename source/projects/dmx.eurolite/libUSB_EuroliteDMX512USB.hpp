@@ -5,21 +5,100 @@
  * Andrzej Kopeć, 2018
  */
 
+#pragma once
+
 #include <cstring>
+#include <cstdint>
 #include <algorithm>
+#include <atomic>
 #include <mutex>
 #include <string>
 #include <sstream>
+#include <vector>
 #include "libusb-1.0/libusb.h"
+#include "RDMController.hpp"
+#include "DMXLayer.hpp"
+
+/**
+ * A single DMX frame received by the widget (label 5).
+ * Frames live in a preallocated ring inside the device class
+ * and are filled directly by the USB packet parser.
+ */
+struct DMXInputFrame
+{
+    // steady clock timestamp of packet completion (microseconds)
+    uint64_t timestamp_us;
+
+    // widget receive status (bit 0: queue overflow, bit 1: overrun)
+    unsigned char status;
+
+    // DMX start code of the received packet
+    unsigned char start_code;
+
+    // number of valid slots in the frame
+    unsigned short size;
+
+    // slot values
+    unsigned char slots[512];
+};
+
+/**
+ * A single slot change reported by the widget in
+ * receive-on-change mode (label 9).
+ */
+struct DMXInputChange
+{
+    // channel number (zero based)
+    unsigned short channel;
+
+    // new value
+    unsigned char value;
+};
+
+/**
+ * Gets notified about every frame handed to the device.
+ */
+class DMXFrameListener
+{
+  public:
+    virtual ~DMXFrameListener() {}
+
+    /** Called right after the frame was submitted (on the thread
+     *  servicing transfers), must not block.
+     *
+     *  @param  slots   Transmitted slot values
+     *  @param  size    Count of slots (512)
+     */
+    virtual void frame_sent(const unsigned char *slots, int size) = 0;
+
+    /**
+     * Called before the next frame is built (layers are merged after
+     * that), a chance to publish fresh data into a layer.
+     */
+    virtual void frame_will_build() {}
+
+    /** Called when the frame is complete (layers merged), right before
+     *  it is handed to the device. Listeners may modify it and run in
+     *  the order they were added.
+     *
+     *  @param  slots   Slot values to be transmitted
+     *  @param  size    Count of slots (512)
+     */
+    virtual void frame_will_send(unsigned char * /* slots */, int /* size */) {}
+};
 
-class LibUSB_EuroliteDMX512USB
+class LibUSB_EuroliteDMX512USB : public RDMTransport
 {
   public:
     LibUSB_EuroliteDMX512USB();
 
     ~LibUSB_EuroliteDMX512USB();
 
-    bool open_device();
+    /** Opens the device
+     * 
+     *  @param  index   Which of the connected widgets to open (zero based)
+     */
+    bool open_device(int index = 0);
 
     void close_device();
 
@@ -56,9 +135,65 @@ class LibUSB_EuroliteDMX512USB
 
     void set_channel_memcpy_from(int from, int c, unsigned char *v);
 
+    /** Sets 16-bit values for consecutive coarse/fine channel pairs,
+     *  both bytes of every pair always end up in the same frame
+     *
+     *  @param  from        The first channel of the first pair
+     *  @param  c           Count of 16-bit values (pairs)
+     *  @param  v           Values
+     *  @param  lsb_first   Fine byte goes first in each pair
+     */
+    void set_channel16_from(int from, int c, const uint16_t *v, bool lsb_first = false);
+
+    /** Sets normalised values (0.-1.) for consecutive channels
+     *
+     *  @param  from    The first channel number to place values.
+     *  @param  c       Count of values
+     *  @param  v       Values, clamped to 0.-1. (NaN gives 0)
+     *
+     *  The value is kept with 8 fractional bits, so with dithering
+     *  enabled the channel alternates between neighbouring levels
+     *  to hit it on average. Writing the channel with another value
+     *  by other means ends it.
+     */
+    void set_channel_float_from(int from, int c, const float *v);
+
+    /**
+     * Enables temporal dithering of channels set with set_channel_float_from.
+     */
+    void set_dither(bool will_be_dithered);
+
+    bool get_dither();
+
+    /** Copies the back buffer (values as set, before any merging)
+     *
+     *  @param  dest    512 bytes
+     */
+    void get_channels(unsigned char *dest);
+
+    /** Lets the caller write values straight into the back buffer,
+     *  avoiding an intermediate copy.
+     *
+     *  @param  from    The first channel number to place values.
+     *  @param  c       Count of values (clipped to the universe)
+     *  @param  write   Called as write(unsigned char *dest, int count)
+     *                  with the data lock held, keep it short
+     */
+    template <typename Writer>
+    void write_channels(int from, int c, Writer write)
+    {
+        if (from < 0 || from > 511 || c <= 0) // safety check
+            return;
+        if (c + from > 512) // safety check
+            c = 512 - from;
+        std::lock_guard<std::mutex> lock(data_mutex);
+        write(data + 5 + from, c);
+    }
+
     // ---- SYNC TRANSFER ----
     /**
-     * Transfer data in blocking (sync) mode.
+     * Transfer data in blocking (sync) mode. Skipped if called before
+     * the previous frame left the wire (see get_frame_period_us()).
      */
     void sync_transfer_data();
 
@@ -94,16 +229,168 @@ class LibUSB_EuroliteDMX512USB
      */
     void enable_async_transfer(bool will_be_enabled);
 
+    /**
+     * Never block when handling events, for hosts servicing the device
+     * from their own scheduler thread (e.g. Pd clocks).
+     */
+    void set_nonblocking_events(bool nonblocking);
+
+    // ---- DMX INPUT ----
+
+    /**
+     * Enable or disable reading of the IN endpoint.
+     * When enabled, widget packets are parsed into the input ring.
+     */
+    void enable_input(bool will_be_enabled);
+
+    /**
+     * Enable or disable reporting of received frames.
+     * If disabled, frames are not queued for the consumer
+     * (the latest one is still kept for merging).
+     */
+    void set_input_report(bool will_be_reported);
+
+    /**
+     * Enable or disable HTP merge of the latest received frame
+     * into the transmitted frame.
+     */
+    void set_input_merge(bool will_be_merged);
+
+    /**
+     * Switch the widget between sending every received frame (label 5)
+     * and sending only changed slots (label 9).
+     */
+    void set_input_on_change(bool on_change);
+
+    /**
+     * Services libusb events without submitting an output frame.
+     * Keeps the IN transfer going when input is enabled.
+     */
+    void service_input();
+
+    /**
+     * Returns the oldest unconsumed input frame or NULL.
+     * The frame stays valid until input_frame_release() is called.
+     */
+    const DMXInputFrame *input_frame_peek();
+
+    /**
+     * Releases the frame returned by input_frame_peek().
+     */
+    void input_frame_release();
+
+    /**
+     * Copies pending slot changes (receive-on-change mode) to dest.
+     * 
+     *  @param  dest    Destination array
+     *  @param  max     Size of destination array
+     *  @return         Count of changes copied
+     */
+    int input_changes_read(DMXInputChange *dest, int max);
+
+    // ---- LAYERS ----
+
+    /**
+     * Adds a layer (not owned) merged into every transmitted frame.
+     * Layers are merged in the order they were added.
+     */
+    void add_layer(DMXLayer *layer);
+
+    void remove_layer(DMXLayer *layer);
+
+    /**
+     * Adds a listener (not owned) notified about transmitted frames.
+     */
+    void add_frame_listener(DMXFrameListener *listener);
+
+    void remove_frame_listener(DMXFrameListener *listener);
+
+    // ---- RDM ----
+
+    /**
+     * Attaches an RDM controller (not owned), NULL detaches.
+     * Responses received from the line are passed to it and it is
+     * ticked once per serviced frame, so RDM packets are interleaved
+     * with DMX frames.
+     */
+    void set_rdm_controller(RDMController *controller);
+
+    /**
+     * RDMTransport - submits RDM packet (label 7) or discovery
+     * request (label 11) without blocking, the widget sends it
+     * between DMX frames.
+     */
+    bool rdm_send(const unsigned char *packet, int length, bool discovery) override;
+
+    /**
+     * RDMTransport - false while the last RDM packet is being submitted.
+     */
+    bool rdm_ready() override;
+
+    // ---- WIDGET PARAMETERS ----
+
+    /**
+     * Asks the widget for its parameters (label 3) and waits for the reply.
+     * 
+     *  @return true if the reply arrived within timeout
+     */
+    bool request_widget_parameters();
+
+    /**
+     * Sets the widget DMX output timing (label 4).
+     * Times are in microseconds and are rounded to widget units (10.67 us).
+     * 
+     *  @param  break_us    Break time (96 - 1355 us)
+     *  @param  mab_us      Mark after break time (11 - 1355 us)
+     *  @param  rate        Output rate in packets per second (0 - 40, 0 = max)
+     *  @return true if the message was sent
+     */
+    bool set_widget_parameters(int break_us, int mab_us, int rate);
+
+    int get_break_time_us();
+
+    int get_mab_time_us();
+
+    int get_output_rate();
+
+    int get_firmware_version();
+
+    /**
+     * Time needed to send one frame, as limited by the DMX timing on the
+     * wire and by the widget output rate (microseconds).
+     */
+    unsigned int get_frame_period_us();
+
     // ---- ACCESS THE STATE ----
 
     bool is_ready();
 
     bool get_async_transfer_enabled();
 
+    bool get_input_enabled();
+
+    bool get_input_report();
+
+    bool get_input_merge();
+
+    bool get_input_on_change();
+
+    unsigned int get_input_overruns();
+
     void set_timeout(int atimeout);
 
     unsigned int get_timeout();
 
+    /**
+     * Count of frames handed to the device since construction.
+     */
+    unsigned long get_frames_sent();
+
+    /**
+     * Count of failed transfers/submits since construction.
+     */
+    unsigned long get_transfer_errors();
+
     std::string get_channels_as_string();
 
     const char *get_sync_transfer_status_name();
@@ -114,6 +401,8 @@ class LibUSB_EuroliteDMX512USB
 
     const char *get_async_event_status_name();
 
+    const char *get_input_transfer_status_name();
+
   private:
     // --- device state
 
@@ -133,6 +422,15 @@ class LibUSB_EuroliteDMX512USB
     // last sync transfer return status
     int sync_transfer_status = LIBUSB_SUCCESS;
 
+    // statistics
+    std::atomic<unsigned long> frames_sent;
+    std::atomic<unsigned long> transfer_errors;
+
+    /**
+     * Opens index-th device with matching VID/PID.
+     */
+    libusb_device_handle *open_device_by_index(int index);
+
     // --- DMX data
 
     // actual data (buffer) sent to USB device
@@ -144,13 +442,36 @@ class LibUSB_EuroliteDMX512USB
     // mutex on data buffer manipulation
     std::mutex data_mutex;
 
+    // --- normalised (fine) values, guarded by data_mutex
+
+    // value * 255 in 8.8 fixed point
+    uint16_t fine_data[512];
+
+    // channel was last set with set_channel_float_from
+    bool fine_active[512];
+
+    // accumulated quantisation error of each channel (frame builder only)
+    uint16_t dither_error[512];
+
+    bool dither = false;
+
+    /**
+     * Replaces rounded fine channels in out with the dithered level
+     * (data_mutex held).
+     */
+    void dither_fine_channels(unsigned char *out);
+
+    // the frame actually handed to libusb, built from data
+    // right before each transfer (see build_frame)
+    unsigned char *tx_data;
+
     // --- async transmission data
 
     // libusb_trasfer structure
     struct libusb_transfer *xfr = NULL;
 
-    // timeout for handling libusb events // unused for now
-    // struct timeval zero_tv = (struct timeval){ 0 };
+    // timeout for handling libusb events (used when input is enabled)
+    struct timeval zero_tv = {0, 0};
 
     // a flag indicating if we can submit next transfer
     bool async_transfer_pending = false;
@@ -162,6 +483,9 @@ class LibUSB_EuroliteDMX512USB
     // to disabled (wait to cancel out pending submissions)
     bool async_transfer_wait_for_disable = false;
 
+    // steady clock time of the last submitted frame (us)
+    uint64_t last_frame_us = 0;
+
     // last async transfer result from callback
     libusb_transfer_status async_transfer_status = LIBUSB_TRANSFER_COMPLETED;
 
@@ -177,6 +501,180 @@ class LibUSB_EuroliteDMX512USB
      */
     static void cb_async_xfr_complete(struct libusb_transfer *x);
 
+    // --- RDM output (own transfer, queued on the OUT endpoint after
+    // the DMX frame in flight)
+
+    struct libusb_transfer *rdm_xfr = NULL;
+    bool rdm_transfer_pending = false;
+    // RDM packet (up to 257 bytes) framed as a widget message
+    unsigned char rdm_msg[257 + 5];
+
+    static void cb_rdm_xfr_complete(struct libusb_transfer *x);
+
+    // --- DMX input data
+
+    // libusb_transfer structure for the IN endpoint
+    struct libusb_transfer *in_xfr = NULL;
+
+    // raw buffer for the IN transfer
+    static const size_t in_buffer_size = 1024;
+    unsigned char in_buffer[in_buffer_size];
+
+    // a flag indicating if the IN transfer is submitted
+    bool input_transfer_pending = false;
+
+    // a flag indicating if reading of the IN endpoint is enabled
+    bool input_enabled = false;
+
+    // flags for handling received frames
+    bool input_report = true;
+    bool input_merge = false;
+    bool input_on_change = false;
+
+    // last IN transfer result from callback
+    libusb_transfer_status input_transfer_status = LIBUSB_TRANSFER_COMPLETED;
+
+    // ring of received frames (single producer: parser,
+    // single consumer: input_frame_peek/release)
+    static const unsigned int input_ring_size = 8;
+    DMXInputFrame input_ring[input_ring_size];
+    std::atomic<unsigned int> input_ring_head;
+    std::atomic<unsigned int> input_ring_tail;
+
+    // index of the last completed frame (for merging), -1 if none
+    std::atomic<int> input_latest;
+
+    // count of frames (or changes) dropped because a ring was full
+    unsigned int input_overruns = 0;
+
+    // universe as known from change packets (receive-on-change mode)
+    unsigned char input_universe[512];
+
+    // ring of slot changes (single producer / single consumer)
+    static const unsigned int input_changes_size = 1024;
+    DMXInputChange input_changes[input_changes_size];
+    std::atomic<unsigned int> input_changes_head;
+    std::atomic<unsigned int> input_changes_tail;
+
+    // widget packet parser state
+    enum rx_state_t
+    {
+        RX_WAIT_START,
+        RX_LABEL,
+        RX_LENGTH_LSB,
+        RX_LENGTH_MSB,
+        RX_PAYLOAD,
+        RX_END
+    };
+    rx_state_t rx_state = RX_WAIT_START;
+    unsigned char rx_label = 0;
+    unsigned int rx_length = 0;
+    unsigned int rx_count = 0;
+    // received DMX goes to the ring (decided at its first byte)
+    bool rx_to_ring = false;
+
+    // scratch payload for labels other than received DMX, and for
+    // received DMX while the ring is full (RDM responses still count)
+    static const size_t rx_payload_size = 600;
+    unsigned char rx_payload[rx_payload_size];
+
+    // --- layers
+
+    // guards the list, not the layers (taken once per frame)
+    std::mutex layers_mutex;
+    std::vector<DMXLayer *> layers;
+
+    // guarded by layers_mutex as well
+    std::vector<DMXFrameListener *> frame_listeners;
+
+    /**
+     * Notifies frame listeners about tx_data.
+     */
+    void notify_frame_sent();
+
+    // handle events with zero timeout even without input
+    bool nonblocking_events = false;
+
+    // --- RDM
+
+    RDMController *rdm = NULL;
+
+    /**
+     * True if the IN endpoint should be read (input or RDM).
+     */
+    bool input_wanted();
+
+    // --- widget parameters (in widget units of 10.67 us)
+
+    // a flag indicating if parameters were read from the widget
+    bool params_valid = false;
+
+    // a flag indicating if parameters were set by user
+    // (sent again when the device is opened)
+    bool params_set = false;
+
+    int firmware_version = 0;
+    unsigned char break_time = 9;
+    unsigned char mab_time = 1;
+    unsigned char output_rate = 40;
+
+    // cached result of frame period calculation (0 = no pacing)
+    unsigned int frame_period_us = 0;
+
+    /**
+     * Recalculates frame_period_us from the widget parameters.
+     */
+    void update_frame_period();
+
+    /**
+     * A callback function for the IN transfer
+     */
+    static void cb_input_xfr_complete(struct libusb_transfer *x);
+
+    /**
+     * Submits the IN transfer if input is enabled and nothing is pending.
+     */
+    void input_transfer_submit();
+
+    /**
+     * Feeds raw bytes from the IN endpoint to the packet parser.
+     */
+    void parse_widget_bytes(const unsigned char *bytes, int length);
+
+    /**
+     * Called by the parser when a complete packet was received.
+     */
+    void handle_widget_packet();
+
+    /**
+     * Decodes a change-of-state packet (label 9) from rx_payload.
+     */
+    void handle_change_packet();
+
+    /**
+     * Tells the widget which receive mode to use (label 8).
+     */
+    void send_receive_mode();
+
+    /**
+     * Sends a short (non-DMX) message to the widget (blocking).
+     */
+    int send_widget_message(unsigned char label, const unsigned char *payload, int length);
+
+    /**
+     * Frames a widget message (start, label, length, payload, end)
+     * into msg, which has room for length + 5 bytes.
+     *
+     *  @return the message size
+     */
+    static int build_widget_message(unsigned char *msg, unsigned char label,
+                                    const unsigned char *payload, int length);
+
+    /**
+     * Builds tx_data from data and enabled processing stages.
+     */
+    void build_frame();
+
     /**
      * Initalize LibUSB
      */
@@ -0,0 +1,114 @@
+/**
+ * Plain C interface to the Eurolite USB DMX512 PRO engine
+ * for hosts that can't use the C++ class (C programs, ctypes...).
+ * Andrzej Kopeć, 2018
+ *
+ * Channels are zero based. Functions returning int return 0 on success
+ * and a negative value on failure.
+ * Writes are thread safe and may come from any thread; publishing
+ * a device should be done from one thread at a time.
+ */
+
+#ifndef DMX_EUROLITE_H
+#define DMX_EUROLITE_H
+
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define DMX_EUROLITE_API __declspec(dllexport)
+#else
+#define DMX_EUROLITE_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* bumped on incompatible changes of this header */
+#define DMX_EUROLITE_API_VERSION 1
+
+typedef struct dmx_device dmx_device;
+
+typedef struct dmx_stats_t
+{
+    uint64_t frames_sent;
+    uint64_t transfer_errors;
+    uint32_t frame_period_us; /* time one frame takes on the wire */
+    int32_t ready;            /* 0 once the device was unplugged */
+} dmx_stats_t;
+
+/**
+ * Called after every frame handed to the widget (from the thread
+ * publishing), slots points to size channel values.
+ */
+typedef void (*dmx_frame_callback)(void *user_data, const unsigned char *slots, int size);
+
+DMX_EUROLITE_API int dmx_api_version(void);
+
+/**
+ * Opens the index-th connected widget (0 = first one).
+ * Returns NULL if it can't be opened.
+ */
+DMX_EUROLITE_API dmx_device *dmx_open(int index);
+
+/**
+ * Closes the device and frees the handle.
+ */
+DMX_EUROLITE_API void dmx_close(dmx_device *device);
+
+/**
+ * USB transfer timeout in ms (default 150).
+ */
+DMX_EUROLITE_API void dmx_set_timeout(dmx_device *device, int timeout_ms);
+
+DMX_EUROLITE_API int dmx_write(dmx_device *device, int channel, unsigned char value);
+
+/**
+ * Writes count values from start in one call (one lock).
+ * Values past channel 511 are ignored.
+ */
+DMX_EUROLITE_API int dmx_write_range(dmx_device *device, int start, int count,
+                                     const unsigned char *values);
+
+/**
+ * Writes count 16-bit values to consecutive channel pairs from start,
+ * coarse byte first unless lsb_first is set. Both bytes of a value
+ * always go out in the same frame.
+ */
+DMX_EUROLITE_API int dmx_write_range16(dmx_device *device, int start, int count,
+                                       const uint16_t *values, int lsb_first);
+
+/**
+ * Sets all channels to 0.
+ */
+DMX_EUROLITE_API void dmx_clear(dmx_device *device);
+
+/**
+ * Sends the current frame, blocks until the transfer completes
+ * or times out. A frame published before the previous one left the
+ * wire (see frame_period_us) is skipped. Once the widget is unplugged publishing fails and
+ * dmx_stats() reports ready 0; close the device and open it again.
+ */
+DMX_EUROLITE_API int dmx_publish(dmx_device *device);
+
+/**
+ * Submits the current frame without blocking (paced to the widget
+ * frame rate) and handles completed transfers. Call it regularly,
+ * e.g. from the host's frame timer.
+ */
+DMX_EUROLITE_API int dmx_publish_async(dmx_device *device);
+
+/**
+ * Sets (or removes with NULL) the callback run after each sent frame.
+ */
+DMX_EUROLITE_API void dmx_set_frame_callback(dmx_device *device,
+                                             dmx_frame_callback callback,
+                                             void *user_data);
+
+DMX_EUROLITE_API int dmx_stats(dmx_device *device, dmx_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
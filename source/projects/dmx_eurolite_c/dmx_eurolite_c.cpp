@@ -0,0 +1,130 @@
+#include "dmx_eurolite.h"
+#include "libUSB_EuroliteDMX512USB.hpp"
+
+/**
+ * Forwards sent frames to the C callback.
+ */
+class CallbackListener : public DMXFrameListener
+{
+  public:
+    dmx_frame_callback callback = NULL;
+    void *user_data = NULL;
+
+    void frame_sent(const unsigned char *slots, int size) override
+    {
+        if (callback)
+            callback(user_data, slots, size);
+    }
+};
+
+struct dmx_device
+{
+    LibUSB_EuroliteDMX512USB engine;
+    CallbackListener listener;
+};
+
+int dmx_api_version(void)
+{
+    return DMX_EUROLITE_API_VERSION;
+}
+
+dmx_device *dmx_open(int index)
+{
+    if (index < 0)
+        return NULL;
+    dmx_device *device = new dmx_device();
+    device->engine.set_timeout(150);
+    // the host drives transfers, never wait for libusb events
+    device->engine.set_nonblocking_events(true);
+    if (!device->engine.open_device(index))
+    {
+        delete device;
+        return NULL;
+    }
+    device->engine.add_frame_listener(&device->listener);
+    return device;
+}
+
+void dmx_close(dmx_device *device)
+{
+    if (!device)
+        return;
+    device->engine.remove_frame_listener(&device->listener);
+    device->engine.close_device();
+    delete device;
+}
+
+void dmx_set_timeout(dmx_device *device, int timeout_ms)
+{
+    if (device)
+        device->engine.set_timeout(timeout_ms);
+}
+
+int dmx_write(dmx_device *device, int channel, unsigned char value)
+{
+    if (!device || channel < 0 || channel > 511)
+        return -1;
+    device->engine.set_channel(channel, value);
+    return 0;
+}
+
+int dmx_write_range(dmx_device *device, int start, int count,
+                    const unsigned char *values)
+{
+    if (!device || !values || start < 0 || start > 511 || count < 0)
+        return -1;
+    device->engine.set_channel_memcpy_from(start, count, const_cast<unsigned char *>(values));
+    return 0;
+}
+
+int dmx_write_range16(dmx_device *device, int start, int count,
+                      const uint16_t *values, int lsb_first)
+{
+    if (!device || !values || start < 0 || start > 511 || count < 0)
+        return -1;
+    device->engine.set_channel16_from(start, count, values, lsb_first != 0);
+    return 0;
+}
+
+void dmx_clear(dmx_device *device)
+{
+    if (device)
+        device->engine.clear_all_channels();
+}
+
+int dmx_publish(dmx_device *device)
+{
+    if (!device || !device->engine.is_ready())
+        return -1;
+    const unsigned long errors = device->engine.get_transfer_errors();
+    device->engine.sync_transfer_data();
+    return device->engine.get_transfer_errors() == errors ? 0 : -1;
+}
+
+int dmx_publish_async(dmx_device *device)
+{
+    if (!device || !device->engine.is_ready())
+        return -1;
+    device->engine.service_async_transfer();
+    return device->engine.is_ready() ? 0 : -1;
+}
+
+void dmx_set_frame_callback(dmx_device *device, dmx_frame_callback callback,
+                            void *user_data)
+{
+    if (!device)
+        return;
+    device->listener.user_data = user_data;
+    device->listener.callback = callback;
+}
+
+int dmx_stats(dmx_device *device, dmx_stats_t *stats)
+{
+    if (!device || !stats)
+        return -1;
+    stats->frames_sent = device->engine.get_frames_sent();
+    stats->transfer_errors = device->engine.get_transfer_errors();
+    stats->frame_period_us = device->engine.get_frame_period_us();
+    stats->ready = device->engine.is_ready() ? 1 : 0;
+    return 0;
+}
@@ -0,0 +1,245 @@
+/**
+        @file
+        dmx_eurolite - Pure Data interface for Eurolite USB DMX512 PRO device.
+        Uses the same engine as the Max external, output is scheduled
+        with a Pd clock.
+*/
+
+#include <algorithm>
+#include "m_pd.h"
+#include "libUSB_EuroliteDMX512USB.hpp"
+
+static const char *version_string = "v0.2c";
+
+// default output clock rate (Hz), widget pacing limits the actual rate
+static const double default_output_rate = 40.;
+
+struct t_dmx_eurolite
+{
+  t_object x_obj;
+  LibUSB_EuroliteDMX512USB *dmx;
+  t_clock *output_clock;
+  double output_interval; // ms, 0 = output on bang only
+  bool lsb_first;         // byte order of set16 pairs
+  t_outlet *ready_outlet;
+};
+
+static t_class *this_class = NULL;
+
+// Clock task - runs in Pd's scheduler, never blocks
+static void dmx_eurolite_output_tick(t_dmx_eurolite *x)
+{
+  x->dmx->service_async_transfer();
+  if (x->output_interval > 0)
+    clock_delay(x->output_clock, x->output_interval);
+}
+
+static void dmx_eurolite_rate(t_dmx_eurolite *x, t_floatarg rate)
+{
+  if (rate > 0)
+  {
+    x->output_interval = 1000. / std::min((double)rate, 1000.);
+    clock_delay(x->output_clock, 0);
+  }
+  else
+  {
+    x->output_interval = 0;
+    clock_unset(x->output_clock);
+  }
+}
+
+static void *dmx_eurolite_new(t_symbol *s, int argc, t_atom *argv)
+{
+  t_dmx_eurolite *x = (t_dmx_eurolite *)pd_new(this_class);
+
+  x->dmx = new LibUSB_EuroliteDMX512USB();
+  x->dmx->set_timeout(150);
+  x->dmx->set_nonblocking_events(true);
+  x->output_clock = clock_new(x, (t_method)dmx_eurolite_output_tick);
+  x->output_interval = 0;
+  x->lsb_first = false;
+  x->ready_outlet = outlet_new(&x->x_obj, &s_float);
+
+  // [dmx_eurolite <rate>]
+  dmx_eurolite_rate(x, argc > 0 ? atom_getfloat(argv) : default_output_rate);
+
+  return x;
+}
+
+static void dmx_eurolite_free(t_dmx_eurolite *x)
+{
+  clock_unset(x->output_clock);
+  clock_free(x->output_clock);
+  delete x->dmx;
+}
+
+// sends current frame right away (blocking)
+static void dmx_eurolite_bang(t_dmx_eurolite *x)
+{
+  x->dmx->sync_transfer_data();
+}
+
+static void dmx_eurolite_open(t_dmx_eurolite *x)
+{
+  if (!x->dmx->open_device())
+    pd_error(x, "dmx_eurolite: can't open device");
+  outlet_float(x->ready_outlet, x->dmx->is_ready() ? 1 : 0);
+}
+
+static void dmx_eurolite_close(t_dmx_eurolite *x)
+{
+  x->dmx->close_device();
+  outlet_float(x->ready_outlet, 0);
+}
+
+static void dmx_eurolite_clear(t_dmx_eurolite *x)
+{
+  x->dmx->clear_all_channels();
+}
+
+static void dmx_eurolite_timeout(t_dmx_eurolite *x, t_floatarg ms)
+{
+  x->dmx->set_timeout(std::max(25, std::min(2500, (int)ms)));
+}
+
+static void dmx_eurolite_setchannel(t_dmx_eurolite *x, t_floatarg ch,
+                                    t_floatarg val)
+{
+  x->dmx->set_channel(
+      (int)ch, static_cast<unsigned char>(std::max(0, std::min(255, (int)val))));
+}
+
+/**
+ * Converts atoms to channel values in a single pass, floats are
+ * clamped to 0-255 and truncated, symbols give 0.
+ */
+static void atoms_to_channels(const t_atom *argv, unsigned char *dest, int count)
+{
+  for (int i = 0; i < count; i++)
+  {
+    const t_float f = argv[i].a_type == A_FLOAT ? argv[i].a_w.w_float : 0;
+    dest[i] = f > 0 ? (unsigned char)std::min<t_float>(255, f) : 0; // NaN too
+  }
+}
+
+/**
+ * set <ch_num> <val1> [<val2>...], like "set" in [table]
+ */
+static void dmx_eurolite_set(t_dmx_eurolite *x, t_symbol *s, int argc,
+                             t_atom *argv)
+{
+  if (argc < 2)
+    return;
+  const int first = (int)atom_getfloat(argv);
+  x->dmx->write_channels(first, argc - 1, [argv](unsigned char *dest, int count) {
+    atoms_to_channels(argv + 1, dest, count);
+  });
+}
+
+/**
+ * <val1> [<val2>...] from channel 0
+ */
+static void dmx_eurolite_list(t_dmx_eurolite *x, t_symbol *s, int argc,
+                              t_atom *argv)
+{
+  x->dmx->write_channels(0, argc, [argv](unsigned char *dest, int count) {
+    atoms_to_channels(argv, dest, count);
+  });
+}
+
+/**
+ * setf <ch_num> <val1> [<val2>...], values 0.-1.
+ */
+static void dmx_eurolite_setf(t_dmx_eurolite *x, t_symbol *s, int argc,
+                              t_atom *argv)
+{
+  if (argc < 2)
+    return;
+  const int first = (int)atom_getfloat(argv);
+  const int count = std::min(512, argc - 1);
+  float values[512];
+  for (int i = 0; i < count; i++)
+    values[i] = argv[i + 1].a_type == A_FLOAT ? argv[i + 1].a_w.w_float : 0.f;
+  x->dmx->set_channel_float_from(first, count, values);
+}
+
+/**
+ * set16 <ch_num> <val1> [<val2>...], values 0-65535 go to
+ * coarse/fine channel pairs
+ */
+static void dmx_eurolite_set16(t_dmx_eurolite *x, t_symbol *s, int argc,
+                               t_atom *argv)
+{
+  if (argc < 2)
+    return;
+  const int first = (int)atom_getfloat(argv);
+  const int count = std::min(256, argc - 1);
+  uint16_t values[256];
+  for (int i = 0; i < count; i++)
+    values[i] = (uint16_t)std::max(0, std::min(65535, (int)atom_getfloat(argv + 1 + i)));
+  x->dmx->set_channel16_from(first, count, values, x->lsb_first);
+}
+
+// 0 - coarse byte first, 1 - fine byte first
+static void dmx_eurolite_byteorder(t_dmx_eurolite *x, t_floatarg order)
+{
+  x->lsb_first = order != 0;
+}
+
+static void dmx_eurolite_dither(t_dmx_eurolite *x, t_floatarg on)
+{
+  x->dmx->set_dither(on != 0);
+}
+
+static void dmx_eurolite_postinfo(t_dmx_eurolite *x)
+{
+  post("dmx_eurolite %s\n"
+       "Device is %s ready.\n"
+       "Output clock: %s\n"
+       "ASYNC submit status: %s\n"
+       "ASYNC trasfer(cb) status: %s\n"
+       "Frames sent: %lu, errors: %lu\n"
+       "DMX buffer: %s",
+       version_string,
+       (x->dmx->is_ready() ? "" : "not"),
+       (x->output_interval > 0 ? "on" : "off"),
+       x->dmx->get_async_submit_status_name(),
+       x->dmx->get_async_transfer_status_name(),
+       x->dmx->get_frames_sent(),
+       x->dmx->get_transfer_errors(),
+       x->dmx->get_channels_as_string().c_str());
+}
+
+extern "C" void dmx_eurolite_setup(void)
+{
+  this_class = class_new(gensym("dmx_eurolite"), (t_newmethod)dmx_eurolite_new,
+                         (t_method)dmx_eurolite_free,
+                         sizeof(t_dmx_eurolite), CLASS_DEFAULT, A_GIMME, 0);
+
+  class_addbang(this_class, (t_method)dmx_eurolite_bang);
+  class_addmethod(this_class, (t_method)dmx_eurolite_bang, gensym("sync"), A_NULL);
+  class_addmethod(this_class, (t_method)dmx_eurolite_setchannel,
+                  gensym("setchannel"), A_FLOAT, A_FLOAT, A_NULL);
+  class_addmethod(this_class, (t_method)dmx_eurolite_set, gensym("set"),
+                  A_GIMME, A_NULL);
+  class_addlist(this_class, (t_method)dmx_eurolite_list);
+  class_addmethod(this_class, (t_method)dmx_eurolite_setf, gensym("setf"),
+                  A_GIMME, A_NULL);
+  class_addmethod(this_class, (t_method)dmx_eurolite_set16, gensym("set16"),
+                  A_GIMME, A_NULL);
+  class_addmethod(this_class, (t_method)dmx_eurolite_byteorder,
+                  gensym("byteorder"), A_FLOAT, A_NULL);
+  class_addmethod(this_class, (t_method)dmx_eurolite_dither, gensym("dither"),
+                  A_FLOAT, A_NULL);
+  class_addmethod(this_class, (t_method)dmx_eurolite_open, gensym("open"), A_NULL);
+  class_addmethod(this_class, (t_method)dmx_eurolite_close, gensym("close"), A_NULL);
+  class_addmethod(this_class, (t_method)dmx_eurolite_clear, gensym("clear"), A_NULL);
+  class_addmethod(this_class, (t_method)dmx_eurolite_rate, gensym("rate"),
+                  A_FLOAT, A_NULL);
+  class_addmethod(this_class, (t_method)dmx_eurolite_timeout, gensym("timeout"),
+                  A_FLOAT, A_NULL);
+  class_addmethod(this_class, (t_method)dmx_eurolite_postinfo,
+                  gensym("postinfo"), A_NULL);
+
+  post("dmx_eurolite %s", version_string);
+}
@@ -0,0 +1,93 @@
+/**
+ * ArtNetReceiver fed with ArtDmx datagrams over loopback.
+ */
+
+#include <cstring>
+#include "ArtNet.hpp"
+#include "test_check.hpp"
+#include "test_udp.hpp"
+
+/**
+ * Sends ArtDmx with value in every slot and waits until the receiver
+ * has handled it (accepted or dropped).
+ */
+static void send_artdmx(ArtNetReceiver &receiver, unsigned short universe,
+                        unsigned char sequence, unsigned char value, int size = 512)
+{
+    unsigned char packet[18 + 512] = {};
+    std::memcpy(packet, "Art-Net", 8);
+    packet[8] = 0x00; // OpDmx, little endian
+    packet[9] = 0x50;
+    packet[11] = 14; // protocol version
+    packet[12] = sequence;
+    packet[14] = (unsigned char)(universe & 0xff);
+    packet[15] = (unsigned char)(universe >> 8);
+    packet[16] = (unsigned char)(size >> 8);
+    packet[17] = (unsigned char)(size & 0xff);
+    std::memset(packet + 18, value, size);
+    const unsigned int handled = receiver.get_packet_count() + receiver.get_dropped_count();
+    send_loopback(artnet_port, packet, 18 + size);
+    wait_for([&receiver, handled]() {
+        return receiver.get_packet_count() + receiver.get_dropped_count() > handled;
+    }, 200);
+}
+
+static unsigned char merged(ArtNetReceiver &receiver, int index, int slot, unsigned char base = 0)
+{
+    unsigned char out[512];
+    std::memset(out, base, sizeof(out));
+    receiver.get_layer(index)->merge_into(out);
+    return out[slot];
+}
+
+int main()
+{
+    ArtNetReceiver receiver;
+    if (!receiver.start(0x0123, "", 2))
+    {
+        fprintf(stderr, "test_artnet: can't listen on port %d\n", artnet_port);
+        return 1;
+    }
+
+    // nothing published yet: layer leaves the frame alone
+    CHECK_EQUAL(7, merged(receiver, 0, 0, 7));
+
+    send_artdmx(receiver, 0x0123, 1, 100);
+    CHECK_EQUAL(1, receiver.get_packet_count());
+    CHECK_EQUAL(100, merged(receiver, 0, 0));
+    CHECK_EQUAL(100, merged(receiver, 0, 511));
+    // HTP with the frame
+    CHECK_EQUAL(150, merged(receiver, 0, 0, 150));
+
+    // next port address feeds the second layer
+    send_artdmx(receiver, 0x0124, 1, 60, 10);
+    CHECK_EQUAL(60, merged(receiver, 1, 9));
+    CHECK_EQUAL(0, merged(receiver, 1, 10));
+    CHECK_EQUAL(100, merged(receiver, 0, 0));
+
+    // other universes are ignored
+    send_artdmx(receiver, 0x0125, 1, 200);
+    CHECK_EQUAL(2, receiver.get_packet_count());
+    CHECK_EQUAL(100, merged(receiver, 0, 0));
+
+    // late packets are dropped, later ones accepted
+    send_artdmx(receiver, 0x0123, 5, 110);
+    send_artdmx(receiver, 0x0123, 4, 20);
+    CHECK_EQUAL(1, receiver.get_dropped_count());
+    CHECK_EQUAL(110, merged(receiver, 0, 0));
+    send_artdmx(receiver, 0x0123, 6, 120);
+    CHECK_EQUAL(120, merged(receiver, 0, 0));
+
+    // sequence 0 disables sequencing
+    send_artdmx(receiver, 0x0123, 0, 30);
+    CHECK_EQUAL(30, merged(receiver, 0, 0));
+    CHECK_EQUAL(1, receiver.get_dropped_count());
+
+    // LTP layer replaces the frame
+    receiver.get_layer(0)->merge = DMXLayer::MERGE_LTP;
+    CHECK_EQUAL(30, merged(receiver, 0, 0, 250));
+
+    receiver.stop();
+    CHECK_EQUAL(9, merged(receiver, 0, 0, 9));
+    return check_result("test_artnet");
+}
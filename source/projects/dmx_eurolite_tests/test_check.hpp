@@ -0,0 +1,41 @@
+/**
+ * Minimal checks for the core tests (no test framework needed).
+ */
+
+#pragma once
+
+#include <cstdio>
+
+static int check_failures = 0;
+
+#define CHECK(condition)                                                      \
+    do                                                                        \
+    {                                                                         \
+        if (!(condition))                                                     \
+        {                                                                     \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, \
+                    #condition);                                              \
+            check_failures++;                                                 \
+        }                                                                     \
+    } while (0)
+
+#define CHECK_EQUAL(expected, actual)                                          \
+    do                                                                         \
+    {                                                                          \
+        const long long e_ = (long long)(expected), a_ = (long long)(actual); \
+        if (e_ != a_)                                                          \
+        {                                                                      \
+            fprintf(stderr, "%s:%d: %s: expected %lld, got %lld\n", __FILE__,  \
+                    __LINE__, #actual, e_, a_);                                \
+            check_failures++;                                                  \
+        }                                                                      \
+    } while (0)
+
+static int check_result(const char *name)
+{
+    if (check_failures)
+        fprintf(stderr, "%s: %d check(s) failed\n", name, check_failures);
+    else
+        printf("%s: ok\n", name);
+    return check_failures ? 1 : 0;
+}
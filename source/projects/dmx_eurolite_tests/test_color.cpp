@@ -0,0 +1,94 @@
+/**
+ * DMXColorConverter white and amber extraction.
+ */
+
+#include <cstring>
+#include "DMXColorConverter.hpp"
+#include "test_check.hpp"
+
+static void convert(DMXColorConverter &converter, unsigned char *slots,
+                    unsigned char r, unsigned char g, unsigned char b)
+{
+    std::memset(slots, 0, 512);
+    slots[0] = r;
+    slots[1] = g;
+    slots[2] = b;
+    converter.frame_will_send(slots, 512);
+}
+
+static void test_white()
+{
+    DMXColorConverter converter;
+    CHECK(converter.add(0, 1, DMXColorConverter::INPUT_RGB, DMXColorConverter::OUTPUT_RGBW));
+    unsigned char slots[512];
+    // white takes the common part of R G B
+    convert(converter, slots, 255, 128, 64);
+    CHECK_EQUAL(191, slots[0]);
+    CHECK_EQUAL(64, slots[1]);
+    CHECK_EQUAL(0, slots[2]);
+    CHECK_EQUAL(64, slots[3]);
+}
+
+static void test_warm_white()
+{
+    DMXColorConverter converter;
+    CHECK(converter.add(0, 1, DMXColorConverter::INPUT_RGB, DMXColorConverter::OUTPUT_RGBW));
+    converter.set_white_point(1.f, 0.5f, 0.25f);
+    unsigned char slots[512];
+    // red limits the white, the rest stays on the RGB emitters
+    convert(converter, slots, 255, 255, 255);
+    CHECK_EQUAL(255, slots[3]);
+    CHECK_EQUAL(0, slots[0]);
+    CHECK_EQUAL(128, slots[1]);
+    CHECK_EQUAL(191, slots[2]);
+}
+
+static void test_black_white_point()
+{
+    DMXColorConverter converter;
+    CHECK(converter.add(0, 1, DMXColorConverter::INPUT_RGB, DMXColorConverter::OUTPUT_RGBW));
+    converter.set_white_point(0.f, 0.f, 0.f);
+    unsigned char slots[512];
+    convert(converter, slots, 255, 128, 64);
+    CHECK_EQUAL(0, slots[3]);
+    CHECK_EQUAL(255, slots[0]);
+    CHECK_EQUAL(128, slots[1]);
+    CHECK_EQUAL(64, slots[2]);
+}
+
+static void test_amber()
+{
+    DMXColorConverter converter;
+    CHECK(converter.add(0, 1, DMXColorConverter::INPUT_RGB, DMXColorConverter::OUTPUT_RGBA));
+    unsigned char slots[512];
+    // default amber 1. 0.5 0. makes all of the red
+    convert(converter, slots, 255, 255, 0);
+    CHECK_EQUAL(255, slots[3]);
+    CHECK_EQUAL(0, slots[0]);
+    CHECK_EQUAL(128, slots[1]);
+    CHECK_EQUAL(0, slots[2]);
+}
+
+static void test_black_amber_point()
+{
+    DMXColorConverter converter;
+    CHECK(converter.add(0, 1, DMXColorConverter::INPUT_RGB, DMXColorConverter::OUTPUT_RGBAW));
+    converter.set_white_point(0.f, 0.f, 0.f);
+    converter.set_amber_point(0.f, 0.f, 0.f);
+    unsigned char slots[512];
+    convert(converter, slots, 255, 255, 0);
+    CHECK_EQUAL(0, slots[3]);
+    CHECK_EQUAL(0, slots[4]);
+    CHECK_EQUAL(255, slots[0]);
+    CHECK_EQUAL(255, slots[1]);
+}
+
+int main()
+{
+    test_white();
+    test_warm_white();
+    test_black_white_point();
+    test_amber();
+    test_black_amber_point();
+    return check_result("test_color");
+}
@@ -0,0 +1,100 @@
+/**
+ * DMXCurves slot assignment, 8-bit and 16-bit pairs.
+ */
+
+#include <cstring>
+#include "DMXCurves.hpp"
+#include "test_check.hpp"
+
+// with gamma 2, 0x80 0xff reads 0x41.. as a pair but 0x40 0xff as
+// two 8-bit slots
+static const unsigned char coarse_in = 0x80, fine_in = 0xff;
+static const unsigned char coarse_8bit = 0x40, coarse_wide = 0x41;
+
+static void send(DMXCurves &curves, unsigned char *slots)
+{
+    std::memset(slots, 0, 512);
+    slots[10] = coarse_in;
+    slots[11] = fine_in;
+    slots[12] = coarse_in;
+    slots[13] = fine_in;
+    curves.frame_will_send(slots, 512);
+}
+
+static void test_8bit()
+{
+    DMXCurves curves;
+    CHECK(curves.set_gamma(1, 2.f));
+    CHECK(curves.assign(1, 10, 1));
+    CHECK_EQUAL(1, curves.get_assigned_count());
+    unsigned char slots[512];
+    send(curves, slots);
+    CHECK_EQUAL(coarse_8bit, slots[10]);
+    CHECK_EQUAL(fine_in, slots[11]); // linear
+}
+
+static void test_pair()
+{
+    DMXCurves curves;
+    CHECK(curves.set_gamma(1, 2.f));
+    CHECK(curves.assign(1, 10, 2, true));
+    CHECK_EQUAL(4, curves.get_assigned_count());
+    unsigned char slots[512];
+    send(curves, slots);
+    CHECK_EQUAL(coarse_wide, slots[10]);
+    CHECK(slots[11] != fine_in);
+    CHECK_EQUAL(coarse_wide, slots[12]);
+    CHECK_EQUAL(slots[11], slots[13]);
+}
+
+static void test_pair_split_by_fine_slot()
+{
+    DMXCurves curves;
+    CHECK(curves.set_gamma(1, 2.f));
+    CHECK(curves.assign(1, 10, 2, true));
+    // the fine slot of the first pair goes linear: its coarse slot
+    // is on its own now, the second pair is untouched
+    CHECK(curves.assign(0, 11, 1));
+    CHECK_EQUAL(3, curves.get_assigned_count());
+    unsigned char slots[512];
+    send(curves, slots);
+    CHECK_EQUAL(coarse_8bit, slots[10]);
+    CHECK_EQUAL(fine_in, slots[11]);
+    CHECK_EQUAL(coarse_wide, slots[12]);
+}
+
+static void test_pair_split_by_coarse_slot()
+{
+    DMXCurves curves;
+    CHECK(curves.set_gamma(1, 2.f));
+    CHECK(curves.assign(1, 10, 1, true));
+    CHECK(curves.assign(1, 10, 1));
+    unsigned char slots[512];
+    send(curves, slots);
+    CHECK_EQUAL(coarse_8bit, slots[10]);
+    CHECK_EQUAL(fine_in, slots[11]);
+}
+
+static void test_pair_at_universe_end()
+{
+    DMXCurves curves;
+    CHECK(curves.set_gamma(1, 2.f));
+    // the last pair has no fine slot, it is 8-bit
+    CHECK(curves.assign(1, 511, 1, true));
+    CHECK_EQUAL(1, curves.get_assigned_count());
+    unsigned char slots[512];
+    std::memset(slots, 0, sizeof(slots));
+    slots[511] = coarse_in;
+    curves.frame_will_send(slots, 512);
+    CHECK_EQUAL(coarse_8bit, slots[511]);
+}
+
+int main()
+{
+    test_8bit();
+    test_pair();
+    test_pair_split_by_fine_slot();
+    test_pair_split_by_coarse_slot();
+    test_pair_at_universe_end();
+    return check_result("test_curves");
+}
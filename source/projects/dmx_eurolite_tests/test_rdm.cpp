@@ -0,0 +1,354 @@
+/**
+ * RDMController against a simulated line of responders.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <vector>
+#include "RDMController.hpp"
+#include "test_check.hpp"
+
+static const uint64_t controller_uid = 0x7ff000000001ull;
+
+struct SimulatedResponder
+{
+    uint64_t uid;
+    bool muted;
+    // mute requests left unanswered (lost responses)
+    int mute_drops;
+    std::map<uint16_t, std::vector<unsigned char> > parameters;
+};
+
+/**
+ * Answers packets like devices on the line would. A response (if any)
+ * is kept until the test hands it to the controller.
+ */
+class SimulatedLine : public RDMTransport
+{
+  public:
+    std::vector<SimulatedResponder> responders;
+    std::vector<unsigned char> response;
+    bool has_response = false;
+    int dub_count = 0;
+    int collision_count = 0;
+    int send_count = 0;
+    // discovery requests can't be sent (line fault)
+    bool fail_discovery = false;
+    // a packet sent before is still being submitted
+    bool busy = false;
+
+    bool rdm_send(const unsigned char *packet, int length, bool discovery) override
+    {
+        has_response = false;
+        response.clear();
+        if (length < 26 || packet[0] != 0xcc || (discovery && fail_discovery))
+            return false;
+        send_count++;
+        const uint64_t destination = read_uid(packet + 3);
+        const unsigned char command_class = packet[20];
+        const uint16_t pid = (uint16_t)((packet[21] << 8) | packet[22]);
+        const unsigned char *pd = packet + 24;
+        const int pdl = packet[23];
+
+        if (discovery)
+        {
+            dub_count++;
+            const uint64_t lower = read_uid(pd);
+            const uint64_t upper = read_uid(pd + 6);
+            std::vector<const SimulatedResponder *> answering;
+            for (const SimulatedResponder &r : responders)
+                if (!r.muted && r.uid >= lower && r.uid <= upper)
+                    answering.push_back(&r);
+            if (answering.empty())
+                return true;
+            response = discovery_response(answering[0]->uid);
+            // responses sent at the same time garble each other
+            for (size_t i = 1; i < answering.size(); i++)
+            {
+                const std::vector<unsigned char> other = discovery_response(answering[i]->uid);
+                for (size_t k = 0; k < response.size(); k++)
+                    response[k] |= other[k];
+            }
+            if (answering.size() > 1)
+                collision_count++;
+            has_response = true;
+            return true;
+        }
+
+        for (SimulatedResponder &r : responders)
+        {
+            if (destination != rdm_broadcast_uid && destination != r.uid)
+                continue;
+            if (pid == RDM_PID_DISC_UN_MUTE)
+                r.muted = false;
+            else if (pid == RDM_PID_DISC_MUTE)
+            {
+                r.muted = true;
+                if (r.mute_drops > 0)
+                    r.mute_drops--;
+                else
+                    respond(r, packet, 0x11, 0x00, NULL, 0);
+            }
+            else if (command_class == 0x20 || command_class == 0x30)
+            {
+                std::map<uint16_t, std::vector<unsigned char> >::iterator p = r.parameters.find(pid);
+                if (p == r.parameters.end())
+                {
+                    const unsigned char unknown_pid[2] = {0x00, 0x00};
+                    respond(r, packet, command_class + 1, 0x02, unknown_pid, 2);
+                }
+                else if (command_class == 0x20)
+                    respond(r, packet, 0x21, 0x00, p->second.data(), (int)p->second.size());
+                else
+                {
+                    p->second.assign(pd, pd + pdl);
+                    respond(r, packet, 0x31, 0x00, NULL, 0);
+                }
+            }
+        }
+        return true;
+    }
+
+    bool rdm_ready() override
+    {
+        return !busy;
+    }
+
+  private:
+    static uint64_t read_uid(const unsigned char *src)
+    {
+        uint64_t uid = 0;
+        for (int i = 0; i < 6; i++)
+            uid = (uid << 8) | src[i];
+        return uid;
+    }
+
+    static std::vector<unsigned char> discovery_response(uint64_t uid)
+    {
+        std::vector<unsigned char> r(7, 0xfe);
+        r.push_back(0xaa);
+        unsigned int sum = 0;
+        for (int i = 0; i < 6; i++)
+        {
+            const unsigned char b = (unsigned char)(uid >> (8 * (5 - i)));
+            r.push_back(b | 0xaa);
+            r.push_back(b | 0x55);
+            sum += (b | 0xaa) + (b | 0x55);
+        }
+        const unsigned char hi = (unsigned char)(sum >> 8), lo = (unsigned char)sum;
+        r.push_back(hi | 0xaa);
+        r.push_back(hi | 0x55);
+        r.push_back(lo | 0xaa);
+        r.push_back(lo | 0x55);
+        return r;
+    }
+
+    void respond(const SimulatedResponder &r, const unsigned char *request,
+                 unsigned char command_class, unsigned char response_type,
+                 const unsigned char *data, int length)
+    {
+        const int message_length = 24 + length;
+        response.assign(message_length + 2, 0);
+        unsigned char *p = response.data();
+        p[0] = 0xcc;
+        p[1] = 0x01;
+        p[2] = (unsigned char)message_length;
+        std::memcpy(p + 3, request + 9, 6); // back to the controller
+        for (int i = 0; i < 6; i++)
+            p[9 + i] = (unsigned char)(r.uid >> (8 * (5 - i)));
+        p[15] = request[15]; // transaction number
+        p[16] = response_type;
+        p[20] = command_class;
+        p[21] = request[21];
+        p[22] = request[22];
+        p[23] = (unsigned char)length;
+        if (length)
+            std::memcpy(p + 24, data, length);
+        unsigned int checksum = 0;
+        for (int i = 0; i < message_length; i++)
+            checksum += p[i];
+        p[message_length] = (unsigned char)(checksum >> 8);
+        p[message_length + 1] = (unsigned char)checksum;
+        has_response = true;
+    }
+};
+
+/**
+ * Runs the controller until it is idle, delivering responses or
+ * letting requests time out.
+ */
+static void run(RDMController &controller, SimulatedLine &line)
+{
+    uint64_t now = 1000000;
+    for (int step = 0; step < 100000 && controller.is_busy(); step++)
+    {
+        line.has_response = false;
+        controller.tick(now);
+        if (line.has_response)
+            controller.handle_response(line.response.data(), (int)line.response.size());
+        else
+            now += 50000; // the next tick times the request out
+        now += 1000;
+    }
+}
+
+static SimulatedResponder responder(uint64_t uid, int mute_drops = 0)
+{
+    SimulatedResponder r;
+    r.uid = uid;
+    r.muted = false;
+    r.mute_drops = mute_drops;
+    r.parameters[RDM_PID_DMX_START_ADDRESS] = {0x00, 0x01};
+    return r;
+}
+
+static std::vector<uint64_t> discover(SimulatedLine &line)
+{
+    RDMController controller(&line, controller_uid);
+    controller.discover();
+    run(controller, line);
+    RDMResult r;
+    std::vector<uint64_t> uids;
+    CHECK(controller.poll_result(r));
+    CHECK_EQUAL(RDMResult::DISCOVERY, r.kind);
+    uids = r.uids;
+    std::sort(uids.begin(), uids.end());
+    return uids;
+}
+
+static void test_discovery_splits_collisions()
+{
+    SimulatedLine line;
+    // neighbours collide down to the lowest branches
+    line.responders.push_back(responder(0x414c00000010ull));
+    line.responders.push_back(responder(0x414c00000011ull));
+    line.responders.push_back(responder(0x414c00000012ull));
+    line.responders.push_back(responder(0x02a000000001ull));
+    const std::vector<uint64_t> uids = discover(line);
+    CHECK_EQUAL(4, uids.size());
+    if (uids.size() == 4)
+    {
+        CHECK_EQUAL(0x02a000000001ull, uids[0]);
+        CHECK_EQUAL(0x414c00000010ull, uids[1]);
+        CHECK_EQUAL(0x414c00000012ull, uids[3]);
+    }
+    CHECK(line.collision_count > 0);
+}
+
+static void test_discovery_empty_line()
+{
+    SimulatedLine line;
+    CHECK_EQUAL(0, discover(line).size());
+    CHECK_EQUAL(1, line.dub_count);
+}
+
+static void test_discovery_lost_mute()
+{
+    SimulatedLine line;
+    // first mute response lost: retried, nothing else is missed
+    line.responders.push_back(responder(0x414c00000020ull, 1));
+    line.responders.push_back(responder(0x414c00000021ull));
+    line.responders.push_back(responder(0x414c80000000ull));
+    CHECK_EQUAL(3, discover(line).size());
+}
+
+static void test_discovery_mute_never_answered()
+{
+    SimulatedLine line;
+    // a device that never answers mute is still reported and
+    // discovery doesn't get stuck on it
+    line.responders.push_back(responder(0x414c00000030ull, 1000));
+    line.responders.push_back(responder(0x414c00000031ull));
+    CHECK_EQUAL(2, discover(line).size());
+}
+
+static void test_get_set()
+{
+    SimulatedLine line;
+    line.responders.push_back(responder(0x414c00000040ull));
+    RDMController controller(&line, controller_uid);
+
+    const unsigned char address[2] = {0x00, 0x25};
+    controller.set(0x414c00000040ull, RDM_PID_DMX_START_ADDRESS, address, 2);
+    controller.get(0x414c00000040ull, RDM_PID_DMX_START_ADDRESS);
+    controller.get(0x414c00000040ull, RDM_PID_DMX_PERSONALITY);
+    controller.get(0x414c00000099ull, RDM_PID_DMX_START_ADDRESS);
+    run(controller, line);
+
+    RDMResult r;
+    CHECK(controller.poll_result(r));
+    CHECK_EQUAL(RDMResult::SET, r.kind);
+    CHECK_EQUAL(RDMResult::ACK, r.status);
+
+    CHECK(controller.poll_result(r));
+    CHECK_EQUAL(RDMResult::GET, r.kind);
+    CHECK_EQUAL(RDMResult::ACK, r.status);
+    CHECK_EQUAL(2, r.data.size());
+    if (r.data.size() == 2)
+        CHECK_EQUAL(0x25, r.data[1]);
+
+    CHECK(controller.poll_result(r));
+    CHECK_EQUAL(RDMResult::NACK, r.status);
+    CHECK_EQUAL(RDM_PID_DMX_PERSONALITY, r.pid);
+    CHECK_EQUAL(0x0000, r.nack_reason);
+
+    CHECK(controller.poll_result(r));
+    CHECK_EQUAL(RDMResult::TIMEOUT, r.status);
+    CHECK_EQUAL(0x414c00000099ull, r.uid);
+
+    CHECK(!controller.poll_result(r));
+}
+
+static void test_discovery_send_failure_keeps_requests()
+{
+    SimulatedLine line;
+    line.responders.push_back(responder(0x414c00000050ull));
+    line.fail_discovery = true;
+    RDMController controller(&line, controller_uid);
+    controller.discover();
+    controller.get(0x414c00000050ull, RDM_PID_DMX_START_ADDRESS);
+    run(controller, line);
+
+    RDMResult r;
+    CHECK(controller.poll_result(r));
+    CHECK_EQUAL(RDMResult::DISCOVERY, r.kind);
+    CHECK_EQUAL(0, r.uids.size());
+    // the GET queued behind the discovery still gets its answer
+    CHECK(controller.poll_result(r));
+    CHECK_EQUAL(RDMResult::GET, r.kind);
+    CHECK_EQUAL(RDMResult::ACK, r.status);
+    CHECK(!controller.poll_result(r));
+}
+
+static void test_busy_transport_holds_requests()
+{
+    SimulatedLine line;
+    line.responders.push_back(responder(0x414c00000060ull));
+    line.busy = true;
+    RDMController controller(&line, controller_uid);
+    controller.get(0x414c00000060ull, RDM_PID_DMX_START_ADDRESS);
+    controller.tick(1000000);
+    controller.tick(2000000);
+    CHECK_EQUAL(0, line.send_count);
+    CHECK(controller.is_busy());
+
+    line.busy = false;
+    run(controller, line);
+    CHECK_EQUAL(1, line.send_count);
+    RDMResult r;
+    CHECK(controller.poll_result(r));
+    CHECK_EQUAL(RDMResult::ACK, r.status);
+}
+
+int main()
+{
+    test_discovery_splits_collisions();
+    test_discovery_empty_line();
+    test_discovery_lost_mute();
+    test_discovery_mute_never_answered();
+    test_get_set();
+    test_discovery_send_failure_keeps_requests();
+    test_busy_transport_holds_requests();
+    return check_result("test_rdm");
+}
@@ -0,0 +1,140 @@
+/**
+ * SACNReceiver fed with E1.31 data packets over loopback.
+ */
+
+#include <cstring>
+#include "SACN.hpp"
+#include "test_check.hpp"
+#include "test_udp.hpp"
+
+static const unsigned short universe = 7;
+
+struct sacn_packet_t
+{
+    unsigned char cid;
+    unsigned char priority;
+    unsigned char sequence;
+    unsigned char options;
+    unsigned char start_code;
+    unsigned char value;
+    int size;
+};
+
+static sacn_packet_t packet_from(unsigned char cid, unsigned char sequence, unsigned char value)
+{
+    sacn_packet_t p = {cid, 100, sequence, 0, 0x00, value, 512};
+    return p;
+}
+
+/**
+ * Sends an E1.31 data packet and waits until the receiver has handled
+ * it (or a short time for packets it ignores without counting).
+ */
+static void send_e131(SACNReceiver &receiver, const sacn_packet_t &p)
+{
+    unsigned char packet[126 + 512] = {};
+    const int length = 126 + p.size;
+    static const unsigned char acn_id[12] = {'A', 'S', 'C', '-', 'E', '1', '.', '1', '7', 0, 0, 0};
+    // root layer
+    packet[1] = 0x10;
+    std::memcpy(packet + 4, acn_id, 12);
+    packet[16] = (unsigned char)(0x70 | ((length - 16) >> 8));
+    packet[17] = (unsigned char)(length - 16);
+    packet[21] = 0x04; // VECTOR_ROOT_E131_DATA
+    std::memset(packet + 22, p.cid, 16);
+    // framing layer
+    packet[38] = (unsigned char)(0x70 | ((length - 38) >> 8));
+    packet[39] = (unsigned char)(length - 38);
+    packet[43] = 0x02; // VECTOR_E131_DATA_PACKET
+    std::strcpy((char *)packet + 44, "test");
+    packet[108] = p.priority;
+    packet[111] = p.sequence;
+    packet[112] = p.options;
+    packet[113] = (unsigned char)(universe >> 8);
+    packet[114] = (unsigned char)(universe & 0xff);
+    // DMP layer
+    packet[115] = (unsigned char)(0x70 | ((length - 115) >> 8));
+    packet[116] = (unsigned char)(length - 115);
+    packet[117] = 0x02; // VECTOR_DMP_SET_PROPERTY
+    packet[118] = 0xa1;
+    packet[122] = 0x01; // address increment
+    packet[123] = (unsigned char)((p.size + 1) >> 8);
+    packet[124] = (unsigned char)((p.size + 1) & 0xff);
+    packet[125] = p.start_code;
+    std::memset(packet + 126, p.value, p.size);
+
+    const unsigned int handled = receiver.get_packet_count() + receiver.get_dropped_count();
+    const int sources = receiver.get_source_count();
+    send_loopback(sacn_port, packet, length);
+    wait_for([&receiver, handled, sources]() {
+        return receiver.get_packet_count() + receiver.get_dropped_count() > handled ||
+               receiver.get_source_count() != sources;
+    }, 200);
+    // merge runs right after the packet is counted
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+}
+
+static unsigned char merged(SACNReceiver &receiver, int slot)
+{
+    unsigned char out[512] = {};
+    receiver.get_layer()->merge_into(out);
+    return out[slot];
+}
+
+int main()
+{
+    SACNReceiver receiver;
+    // loopback interface for the multicast subscription, the test
+    // sends unicast to the bound port
+    if (!receiver.start(universe, "127.0.0.1") && !receiver.start(universe))
+    {
+        fprintf(stderr, "test_sacn: can't listen on port %d\n", sacn_port);
+        return 1;
+    }
+
+    send_e131(receiver, packet_from(1, 1, 80));
+    CHECK_EQUAL(1, receiver.get_source_count());
+    CHECK_EQUAL(80, merged(receiver, 0));
+
+    // late packet dropped
+    send_e131(receiver, packet_from(1, 0, 10));
+    CHECK_EQUAL(1, receiver.get_dropped_count());
+    CHECK_EQUAL(80, merged(receiver, 0));
+
+    // same priority: HTP between sources
+    send_e131(receiver, packet_from(2, 1, 120));
+    CHECK_EQUAL(2, receiver.get_source_count());
+    CHECK_EQUAL(120, merged(receiver, 0));
+    send_e131(receiver, packet_from(1, 2, 130));
+    CHECK_EQUAL(130, merged(receiver, 0));
+
+    // higher priority source wins even with lower levels
+    sacn_packet_t high = packet_from(3, 1, 40);
+    high.priority = 150;
+    send_e131(receiver, high);
+    CHECK_EQUAL(3, receiver.get_source_count());
+    CHECK_EQUAL(40, merged(receiver, 0));
+
+    // terminated streams leave the merge
+    high.sequence = 2;
+    high.options = 0x40;
+    send_e131(receiver, high);
+    CHECK_EQUAL(2, receiver.get_source_count());
+    CHECK_EQUAL(130, merged(receiver, 0));
+
+    // a new source starting with another start code (per-address
+    // priority) must not take a slot with stale levels
+    sacn_packet_t priority = packet_from(4, 1, 200);
+    priority.start_code = 0xdd;
+    send_e131(receiver, priority);
+    send_e131(receiver, packet_from(1, 3, 135)); // merges again
+    CHECK_EQUAL(2, receiver.get_source_count());
+    CHECK_EQUAL(135, merged(receiver, 0));
+
+    // silent sources time out (2.5 s), the layer stops merging
+    CHECK(wait_for([&receiver]() { return receiver.get_source_count() == 0; }, 4000));
+    CHECK_EQUAL(0, merged(receiver, 0));
+
+    receiver.stop();
+    return check_result("test_sacn");
+}
@@ -0,0 +1,45 @@
+/**
+ * Loopback helpers for the network receiver tests.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <thread>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+/**
+ * Sends one datagram to 127.0.0.1:port.
+ */
+static bool send_loopback(unsigned short port, const unsigned char *data, int length)
+{
+    const int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0)
+        return false;
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    const bool sent = sendto(sock, data, length, 0, (struct sockaddr *)&addr, sizeof(addr)) == length;
+    close(sock);
+    return sent;
+}
+
+/**
+ * Waits until condition() is true, at most timeout_ms.
+ */
+template <typename Condition> static bool wait_for(Condition condition, int timeout_ms = 2000)
+{
+    const std::chrono::steady_clock::time_point deadline =
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (!condition())
+    {
+        if (std::chrono::steady_clock::now() > deadline)
+            return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    return true;
+}
@@ -0,0 +1,335 @@
+/**
+        @file
+        dmx_eurolited - headless daemon driving Eurolite USB DMX512 PRO
+        devices. Frames come from stdin, a Unix socket and/or Art-Net.
+
+        Record format (stdin stream and socket datagrams):
+          <device:1> <start:2> <count:2> <values:count>
+        device is the position of the device in the command line (zero
+        based), start and count are big endian, channels are zero based.
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdarg>
+#include <cerrno>
+#include <csignal>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <getopt.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "libUSB_EuroliteDMX512USB.hpp"
+#include "ArtNet.hpp"
+
+static const char *version_string = "v0.2c";
+
+struct t_device
+{
+  int index;
+  LibUSB_EuroliteDMX512USB *dmx;
+  unsigned long last_frames;
+};
+
+static std::vector<t_device> devices;
+static std::atomic<bool> running(true);
+
+// systemd journal understands "<priority>" prefixes on stderr
+static bool journal = false;
+
+enum
+{
+  LOG_ERR = 3,
+  LOG_WARNING = 4,
+  LOG_INFO = 6
+};
+
+static void log_message(int priority, const char *fmt, ...)
+{
+  va_list args;
+  va_start(args, fmt);
+  if (journal)
+    fprintf(stderr, "<%d>", priority);
+  vfprintf(stderr, fmt, args);
+  fputc('\n', stderr);
+  va_end(args);
+}
+
+static void handle_signal(int)
+{
+  running = false;
+}
+
+/**
+ * Applies records from buf, returns count of bytes consumed
+ * (a partial record at the end is left for later).
+ */
+static size_t apply_records(const unsigned char *buf, size_t length)
+{
+  size_t pos = 0;
+  while (length - pos >= 5)
+  {
+    const unsigned int device = buf[pos];
+    const int start = (buf[pos + 1] << 8) | buf[pos + 2];
+    const int count = (buf[pos + 3] << 8) | buf[pos + 4];
+    if (length - pos - 5 < (size_t)count)
+      break;
+    if (device < devices.size() && count > 0)
+      devices[device].dmx->set_channel_memcpy_from(
+          start, count, const_cast<unsigned char *>(buf + pos + 5));
+    pos += 5 + count;
+  }
+  return pos;
+}
+
+static void stdin_loop()
+{
+  std::vector<unsigned char> buf(4 * (5 + 512));
+  size_t filled = 0;
+  struct pollfd pfd = {STDIN_FILENO, POLLIN, 0};
+  while (running)
+  {
+    // wake up regularly to check if we should stop
+    const int ready = poll(&pfd, 1, 100);
+    if (ready == 0 || (ready < 0 && errno == EINTR))
+      continue;
+    const ssize_t n = ready > 0 ? read(STDIN_FILENO, buf.data() + filled, buf.size() - filled) : -1;
+    if (n <= 0)
+    {
+      log_message(LOG_INFO, "stdin closed");
+      return;
+    }
+    filled += n;
+    const size_t used = apply_records(buf.data(), filled);
+    std::memmove(buf.data(), buf.data() + used, filled - used);
+    filled -= used;
+    if (filled == buf.size()) // garbage, resync
+      filled = 0;
+  }
+}
+
+static void socket_loop(int sock)
+{
+  unsigned char buf[8192];
+  while (running)
+  {
+    const ssize_t n = recv(sock, buf, sizeof(buf), 0);
+    if (n > 0)
+      apply_records(buf, n);
+  }
+}
+
+static int open_unix_socket(const char *path)
+{
+  int sock = socket(AF_UNIX, SOCK_DGRAM, 0);
+  if (sock < 0)
+    return -1;
+  struct sockaddr_un addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+  unlink(path);
+  // wake up regularly to check if we should stop
+  struct timeval tv = {0, 100000};
+  setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+  {
+    close(sock);
+    return -1;
+  }
+  return sock;
+}
+
+static void usage(const char *name)
+{
+  fprintf(stderr,
+          "dmx_eurolited %s\n"
+          "usage: %s [options]\n"
+          "  -d, --device N       open N-th connected widget (repeatable, default 0)\n"
+          "  -r, --rate HZ        output frame rate (default 40)\n"
+          "  -i, --stdin          read records from stdin\n"
+          "  -u, --socket PATH    read records from a Unix datagram socket\n"
+          "  -a, --artnet ADDR    Art-Net port address of the first device\n"
+          "                       (next devices use ADDR+1, ADDR+2...)\n"
+          "  -s, --stats SEC      log statistics every SEC seconds\n"
+          "  -t, --timeout MS     USB transfer timeout (default 150)\n"
+          "Record: <device:1> <start:2> <count:2> <values:count> (big endian)\n",
+          version_string, name);
+}
+
+int main(int argc, char **argv)
+{
+  std::vector<int> device_indices;
+  double rate = 40.;
+  bool use_stdin = false;
+  const char *socket_path = NULL;
+  int artnet_address = -1;
+  int stats_interval = 0;
+  int timeout = 150;
+
+  journal = getenv("JOURNAL_STREAM") != NULL;
+
+  static const struct option options[] = {
+      {"device", required_argument, NULL, 'd'},
+      {"rate", required_argument, NULL, 'r'},
+      {"stdin", no_argument, NULL, 'i'},
+      {"socket", required_argument, NULL, 'u'},
+      {"artnet", required_argument, NULL, 'a'},
+      {"stats", required_argument, NULL, 's'},
+      {"timeout", required_argument, NULL, 't'},
+      {"help", no_argument, NULL, 'h'},
+      {NULL, 0, NULL, 0}};
+  int opt;
+  while ((opt = getopt_long(argc, argv, "d:r:iu:a:s:t:h", options, NULL)) != -1)
+  {
+    switch (opt)
+    {
+    case 'd':
+      device_indices.push_back(std::max(0, atoi(optarg)));
+      break;
+    case 'r':
+      rate = std::max(1., std::min(1000., atof(optarg)));
+      break;
+    case 'i':
+      use_stdin = true;
+      break;
+    case 'u':
+      socket_path = optarg;
+      break;
+    case 'a':
+      artnet_address = std::max(0, std::min(32767, atoi(optarg)));
+      break;
+    case 's':
+      stats_interval = std::max(0, atoi(optarg));
+      break;
+    case 't':
+      timeout = std::max(20, std::min(2500, atoi(optarg)));
+      break;
+    default:
+      usage(argv[0]);
+      return opt == 'h' ? 0 : 1;
+    }
+  }
+  if (device_indices.empty())
+    device_indices.push_back(0);
+
+  signal(SIGINT, handle_signal);
+  signal(SIGTERM, handle_signal);
+  signal(SIGPIPE, SIG_IGN);
+
+  for (size_t i = 0; i < device_indices.size(); i++)
+  {
+    t_device d;
+    d.index = device_indices[i];
+    d.dmx = new LibUSB_EuroliteDMX512USB();
+    d.dmx->set_timeout(timeout);
+    d.last_frames = 0;
+    if (d.dmx->open_device(d.index))
+      log_message(LOG_INFO, "device %d opened", d.index);
+    else
+      log_message(LOG_WARNING, "device %d not available, will retry", d.index);
+    devices.push_back(d);
+  }
+
+  ArtNetReceiver artnet;
+  if (artnet_address >= 0)
+  {
+    if (artnet.start((unsigned short)artnet_address, "", (int)devices.size()))
+    {
+      for (size_t i = 0; i < devices.size(); i++)
+        devices[i].dmx->add_layer(artnet.get_layer((int)i));
+      log_message(LOG_INFO, "Art-Net: listening from port address %d", artnet_address);
+    }
+    else
+      log_message(LOG_ERR, "Art-Net: can't listen on port %d", artnet_port);
+  }
+
+  int sock = -1;
+  std::thread socket_thread;
+  if (socket_path)
+  {
+    sock = open_unix_socket(socket_path);
+    if (sock >= 0)
+    {
+      socket_thread = std::thread(socket_loop, sock);
+      log_message(LOG_INFO, "listening on %s", socket_path);
+    }
+    else
+      log_message(LOG_ERR, "can't bind %s", socket_path);
+  }
+
+  std::thread stdin_thread;
+  if (use_stdin)
+    stdin_thread = std::thread(stdin_loop);
+
+  // ---- output loop ----
+  typedef std::chrono::steady_clock clock;
+  const std::chrono::microseconds period((long)(1000000. / rate));
+  clock::time_point next = clock::now();
+  clock::time_point next_retry = next + std::chrono::seconds(1);
+  clock::time_point next_stats = next + std::chrono::seconds(stats_interval);
+
+  while (running)
+  {
+    const clock::time_point now = clock::now();
+    for (size_t i = 0; i < devices.size(); i++)
+    {
+      t_device &d = devices[i];
+      if (d.dmx->is_ready())
+      {
+        d.dmx->sync_transfer_data();
+        // unplugged: the handle is closed, retried below by index
+        if (!d.dmx->is_ready())
+          log_message(LOG_WARNING, "device %d lost", d.index);
+      }
+      else if (now >= next_retry && d.dmx->open_device(d.index))
+        log_message(LOG_INFO, "device %d opened", d.index);
+    }
+    if (now >= next_retry)
+      next_retry = now + std::chrono::seconds(1);
+
+    if (stats_interval && now >= next_stats)
+    {
+      for (size_t i = 0; i < devices.size(); i++)
+      {
+        t_device &d = devices[i];
+        const unsigned long frames = d.dmx->get_frames_sent();
+        log_message(LOG_INFO, "device %d: %s, %.1f fps, %lu frames, %lu errors",
+                    d.index, d.dmx->is_ready() ? "ready" : "not ready",
+                    (double)(frames - d.last_frames) / stats_interval,
+                    frames, d.dmx->get_transfer_errors());
+        d.last_frames = frames;
+      }
+      next_stats = now + std::chrono::seconds(stats_interval);
+    }
+
+    next += period;
+    if (next < now) // fell behind (e.g. transfer timeout), don't burst
+      next = now + period;
+    std::this_thread::sleep_until(next);
+  }
+
+  log_message(LOG_INFO, "stopping");
+  if (socket_thread.joinable())
+    socket_thread.join();
+  if (stdin_thread.joinable())
+    stdin_thread.join();
+  if (sock >= 0)
+  {
+    close(sock);
+    unlink(socket_path);
+  }
+  artnet.stop();
+  for (size_t i = 0; i < devices.size(); i++)
+  {
+    devices[i].dmx->remove_layer(artnet.get_layer((int)i));
+    delete devices[i].dmx;
+  }
+  return 0;
+}